@@ -46,6 +46,58 @@ void scan_performance(const IndexType index_type) {
   
 }
 
+// lookups over uniformly distributed keys drawn from the whole 32-bit domain,
+// so that half of the keys have the top bit set.
+template<typename KeyT, typename ValueT>
+void uniform_lookup_performance(const IndexType index_type, const int index_param_1, const int index_param_2) {
+
+  size_t n = 10000000;
+
+  std::unique_ptr<DataTable<KeyT, ValueT>> data_table(
+    new DataTable<KeyT, ValueT>());
+  std::unique_ptr<BaseIndex<KeyT, ValueT>> data_index(
+    create_numeric_index<KeyT, ValueT>(index_type, data_table.get(), index_param_1, index_param_2));
+
+  data_index->prepare_threads(1);
+  data_index->register_thread(0);
+
+  FastRandom rand_gen(0);
+
+  std::vector<KeyT> keys;
+  keys.reserve(n);
+
+  // insert
+  for (size_t i = 0; i < n; ++i) {
+
+    KeyT key = rand_gen.next<KeyT>();
+    ValueT value = i + 2048;
+    
+    OffsetT offset = data_table->insert_tuple(key, value);
+    data_index->insert(key, offset.raw_data());
+
+    keys.push_back(key);
+  }
+
+  data_index->reorganize();
+
+
+  TimeMeasurer timer;
+  timer.tic();
+
+  size_t found_count = 0;
+  for (size_t i = 0; i < n; ++i) {
+    std::vector<Uint64> offsets;
+    data_index->find(keys[rand_gen.next<uint64_t>() % n], offsets);
+    found_count += offsets.size();
+  }
+
+  timer.toc();
+
+  std::cout << get_index_name(index_type) << ": " 
+            << n * 1.0 / timer.time_us() << " M lookups/s, " 
+            << found_count << " offsets found" << std::endl;
+}
+
 int main() {
 
   std::vector<IndexType> index_types {
@@ -57,4 +109,11 @@ int main() {
   for (auto index_type : index_types) {
     scan_performance<uint32_t, uint64_t>(index_type);
   }
+
+  uniform_lookup_performance<uint32_t, uint64_t>(IndexType::S_Binary, 10, INVALID_INDEX_PARAM);
+  uniform_lookup_performance<uint32_t, uint64_t>(IndexType::S_KAry, 5, 4);
+  uniform_lookup_performance<uint32_t, uint64_t>(IndexType::S_KAry, 4, 9);
+  uniform_lookup_performance<uint32_t, uint64_t>(IndexType::S_KAry, 3, 17);
+  uniform_lookup_performance<uint32_t, uint64_t>(IndexType::S_Fast, 12, INVALID_INDEX_PARAM);
+  uniform_lookup_performance<uint32_t, uint64_t>(IndexType::S_Eytzinger, INVALID_INDEX_PARAM, INVALID_INDEX_PARAM);
 }
@@ -19,7 +19,8 @@ public:
 
   virtual void insert(const GenericKey &key, const Uint64 &offset) = 0;
 
-  virtual void find(const GenericKey &key, std::vector<Uint64> &offsets) = 0;
+  // lookups take a view, so that looking up bytes held elsewhere copies nothing.
+  virtual void find(const GenericKeyView &key, std::vector<Uint64> &offsets) = 0;
 
   virtual void find_range(const GenericKey &lhs_key, const GenericKey &rhs_key, std::vector<Uint64> &offsets) = 0;
 
@@ -21,6 +21,14 @@ public:
 
   virtual void find(const KeyT &key, std::vector<Uint64> &offsets) = 0;
 
+  // look up count keys at once. offsets[i] receives the offsets matching keys[i].
+  // indexes may interleave the lookups of a batch to overlap their cache misses.
+  virtual void find_batch(const KeyT *keys, const size_t count, std::vector<Uint64> *offsets) {
+    for (size_t i = 0; i < count; ++i) {
+      find(keys[i], offsets[i]);
+    }
+  }
+
   virtual void find_range(const KeyT &lhs_key, const KeyT &rhs_key, std::vector<Uint64> &offsets) = 0;
 
   virtual void scan(const KeyT &key, std::vector<Uint64> &offsets) = 0;
@@ -1,6 +1,34 @@
 #pragma once
 
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include <thread>
+#include <utility>
+
+#include <emmintrin.h>
+
 #include "base_index.h"
+#include "static_allocator.h"
+
+// storage layout of the sorted entries in static indexes.
+enum class StaticLayoutType {
+  // one array of key-offset pairs
+  AoSLayoutType = 0,
+  // a dense key array for searching and a parallel offset array touched only on a hit
+  SoALayoutType,
+};
+
+static std::string get_static_layout_name(const StaticLayoutType layout_type) {
+  if (layout_type == StaticLayoutType::AoSLayoutType) {
+    return "array of structures";
+  } else if (layout_type == StaticLayoutType::SoALayoutType) {
+    return "structure of arrays";
+  } else {
+    ASSERT(false, "invalid layout type");
+    return "";
+  }
+}
 
 template<typename KeyT, typename ValueT>
 class BaseStaticIndex : public BaseIndex<KeyT, ValueT> {
@@ -14,83 +42,667 @@ protected:
     Uint64 offset_;
   };
 
-  static bool compare_func(KeyOffsetPair &lhs, KeyOffsetPair &rhs) {
+  static bool compare_func(const KeyOffsetPair &lhs, const KeyOffsetPair &rhs) {
     return lhs.key_ < rhs.key_;
   }
 
+  static const size_t CACHELINE_SIZE = 64; // unit: byte
+
+  // minimum number of entries handed to a thread during reorganization.
+  static const size_t PARALLEL_GRAIN_SIZE = 1ull << 12;
+
+  // number of samples taken per bucket when choosing sample sort splitters.
+  static const size_t SAMPLE_SORT_OVERSAMPLING = 64;
+
+  // radix sort digits are one byte wide, so that the 256 output streams of a pass
+  // and the histograms of all passes stay in the L1/L2 cache.
+  static const size_t RADIX_BITS = 8;
+  static const size_t RADIX_SIZE = 1ull << RADIX_BITS;
+
+  // fewer entries than this are sorted by comparison.
+  static const size_t RADIX_SORT_THRESHOLD = 1ull << 10;
+
+  // number of lookups of a batch that are advanced in lockstep.
+  // large enough to keep the line fill buffers busy.
+  static const size_t BATCH_GROUP_SIZE = 16;
+
 public:
-  BaseStaticIndex(DataTable<KeyT, ValueT> *table_ptr) : 
-    BaseIndex<KeyT, ValueT>(table_ptr), container_(nullptr), size_(0) {}
+  BaseStaticIndex(DataTable<KeyT, ValueT> *table_ptr, const StaticLayoutType layout_type = StaticLayoutType::AoSLayoutType) : 
+    BaseIndex<KeyT, ValueT>(table_ptr), 
+    layout_type_(layout_type), 
+    container_(nullptr), 
+    keys_(nullptr), 
+    offsets_(nullptr), 
+    key_base_(nullptr), 
+    offset_base_(nullptr), 
+    key_stride_(0), 
+    offset_stride_(0), 
+    size_(0), 
+    thread_count_(1), 
+    allocation_type_(StaticAllocationType::DefaultAllocationType), 
+    source_entries_(nullptr) {}
   
   virtual ~BaseStaticIndex() {
-    delete[] container_;
+    free_array(container_);
     container_ = nullptr;
+
+    free_array(keys_);
+    keys_ = nullptr;
+
+    free_array(offsets_);
+    offsets_ = nullptr;
   }
 
   virtual void insert(const KeyT &key, const Uint64 &offset) final {}
   
   virtual void erase(const KeyT &key) final {}
 
+  // seek to the entries matching key with the search structure of the index,
+  // then stream their offsets.
   virtual void scan(const KeyT &key, std::vector<Uint64> &offsets) final {
-    for (size_t i = 0; i < this->size_; ++i) {
-      if (this->container_[i].key_ == key) {
-        offsets.push_back(this->container_[i].offset_);
-      }
-      if (this->container_[i].key_ > key) {
-        return;
-      }
-    }
+    size_t begin_offset, end_offset;
+    find_matches(key, begin_offset, end_offset);
+
+    base_copy_offsets(begin_offset, end_offset, offsets);
   }
 
   virtual void scan_reverse(const KeyT &key, std::vector<Uint64> &offsets) final {
-    for (int i = this->size_ - 1; i >= 0; --i) {
-      if (this->container_[i].key_ == key) {
-        offsets.push_back(this->container_[i].offset_);
-      }
-      if (this->container_[i].key_ < key) {
-        return;
-      }
+    size_t begin_offset, end_offset;
+    find_matches(key, begin_offset, end_offset);
+
+    if (begin_offset >= end_offset) { return; }
+
+    offsets.reserve(offsets.size() + (end_offset - begin_offset));
+    for (size_t i = end_offset; i > begin_offset; --i) {
+      offsets.push_back(offset_at(i - 1));
     }
   }
 
   virtual void scan_full(std::vector<Uint64> &offsets, const size_t count) final {
     size_t bound = std::min(count, this->size_);
     for (size_t i = 0; i < bound; ++i) {
-      offsets.push_back(this->container_[i].offset_);
+      offsets.push_back(this->offset_at(i));
     }
   }
   
-  virtual void prepare_threads(const size_t thread_count) final {}
+  // reorganize() uses up to thread_count threads.
+  virtual void prepare_threads(const size_t thread_count) final {
+    thread_count_ = std::max(thread_count, (size_t)1);
+  }
 
   virtual void register_thread(const size_t thread_id) final {}
 
   virtual size_t size() const final { return size_; }
 
+  StaticLayoutType get_layout_type() const { return layout_type_; }
+
+  // arrays allocated by reorganize() use the given allocation type.
+  void set_allocation_type(const StaticAllocationType allocation_type) {
+    allocation_type_ = allocation_type;
+  }
+
+  StaticAllocationType get_allocation_type() const { return allocation_type_; }
+
+  // if set, the next reorganize() takes its entries from the given key-sorted pairs
+  // instead of the table. used to rebuild an index from a merge of updates.
+  void set_source_entries(const std::vector<std::pair<KeyT, Uint64>> *source_entries) {
+    source_entries_ = source_entries;
+  }
+
+  // key of the pos-th sorted entry.
+  // layouts only differ in strides, so no branch is taken here.
+  const KeyT& key_at(const size_t pos) const {
+    return *(const KeyT*)(key_base_ + pos * key_stride_);
+  }
+
+  // offset of the pos-th sorted entry.
+  const Uint64& offset_at(const size_t pos) const {
+    return *(const Uint64*)(offset_base_ + pos * offset_stride_);
+  }
+
+  // key of the pos-th sorted entry, for callers off the search path.
+  // indexes that do not keep keys in place decode them here.
+  virtual KeyT get_key(const size_t pos) const {
+    return key_at(pos);
+  }
+
+  // smallest number of entries the index can be built on.
+  virtual size_t get_min_size() const {
+    return 1;
+  }
+
+  // memory footprint of the sorted entries if they were stored in the given layout.
+  // unit: byte.
+  virtual size_t get_storage_size(const StaticLayoutType layout_type) const {
+    if (layout_type == StaticLayoutType::AoSLayoutType) {
+      return size_ * sizeof(KeyOffsetPair);
+    } else {
+      return size_ * (sizeof(KeyT) + sizeof(Uint64));
+    }
+  }
+
 protected:
+  // return the lower (or upper, if is_upper is true) bound of key over all sorted entries.
+  // key lies in [smallest key, largest key], and not all keys are equal.
+  // indexes override this to search with their own structures.
+  virtual size_t find_bound(const KeyT &key, const bool is_upper) {
+    return is_upper ? base_upper_bound(key, 0, size_) : base_lower_bound(key, 0, size_);
+  }
+
   void base_reorganize() {
 
     ASSERT(container_ == nullptr && size_ == 0, "invalid container");
 
     size_t capacity = 0;
-    capacity = this->table_ptr_->size();
-    
-    container_ = new KeyOffsetPair[capacity];
 
-    DataTableIterator<KeyT, ValueT> iterator(this->table_ptr_);
-    while (iterator.has_next()) {
-      auto entry = iterator.next();
-      container_[size_].key_ = *(entry.key_);
-      container_[size_].offset_ = entry.offset_;
-      ++size_;
+    if (source_entries_ != nullptr) {
+
+      // source entries are already sorted
+      capacity = source_entries_->size();
+
+      container_ = allocate_array<KeyOffsetPair>(capacity);
+
+      parallel_for(capacity, PARALLEL_GRAIN_SIZE, [&](const size_t begin_pos, const size_t end_pos) {
+        for (size_t i = begin_pos; i < end_pos; ++i) {
+          container_[i].key_ = (*source_entries_)[i].first;
+          container_[i].offset_ = (*source_entries_)[i].second;
+        }
+      });
+      size_ = capacity;
+
+    } else {
+
+      // blocks may be partially filled, so the tuples of a block
+      // start after the tuples of all blocks before it.
+      size_t block_count = this->table_ptr_->get_block_count();
+      std::vector<size_t> block_begins(block_count + 1, 0);
+      for (size_t i = 0; i < block_count; ++i) {
+        block_begins[i + 1] = block_begins[i] + this->table_ptr_->get_block_size(i);
+      }
+      capacity = block_begins[block_count];
+      
+      container_ = allocate_array<KeyOffsetPair>(capacity);
+
+      // each thread extracts a disjoint range of blocks
+      size_t block_grain_size = std::max(PARALLEL_GRAIN_SIZE / this->table_ptr_->get_max_block_capacity(), (size_t)1);
+      parallel_for(block_count, block_grain_size, [&](const size_t begin_block, const size_t end_block) {
+        DataTableIterator<KeyT, ValueT> iterator(this->table_ptr_, begin_block, end_block);
+        size_t pos = block_begins[begin_block];
+        while (iterator.has_next()) {
+          container_[pos].key_ = iterator.next_key(container_[pos].offset_);
+          ++pos;
+        }
+      });
+      size_ = capacity;
+
+      sort_container();
+    }
+
+    if (layout_type_ == StaticLayoutType::AoSLayoutType) {
+
+      key_base_ = (const char*)(&(container_[0].key_));
+      offset_base_ = (const char*)(&(container_[0].offset_));
+      key_stride_ = sizeof(KeyOffsetPair);
+      offset_stride_ = sizeof(KeyOffsetPair);
+
+    } else {
+
+      // split the sorted pairs into two arrays.
+      keys_ = allocate_array<KeyT>(size_);
+      offsets_ = allocate_array<Uint64>(size_);
+      parallel_for(size_, PARALLEL_GRAIN_SIZE, [&](const size_t begin_pos, const size_t end_pos) {
+        for (size_t i = begin_pos; i < end_pos; ++i) {
+          keys_[i] = container_[i].key_;
+          offsets_[i] = container_[i].offset_;
+        }
+      });
+
+      free_array(container_);
+      container_ = nullptr;
+
+      key_base_ = (const char*)(keys_);
+      offset_base_ = (const char*)(offsets_);
+      key_stride_ = sizeof(KeyT);
+      offset_stride_ = sizeof(Uint64);
+    }
+  }
+
+  // allocate an array of count elements with the allocation type of this index,
+  // aligned to alignment bytes. the array must be released by free_array().
+  template<typename T>
+  T* allocate_array(const size_t count, const size_t alignment = STATIC_ARRAY_HEADER_SIZE) const {
+    return (T*)allocate_static_array(sizeof(T) * count, allocation_type_, alignment);
+  }
+
+  void free_array(void *ptr) const {
+    free_static_array(ptr);
+  }
+
+  // split [0, count) into at most thread_count_ chunks of at least grain_size entries,
+  // and run func(begin, end) on each chunk in its own thread.
+  template<typename FuncT>
+  void parallel_for(const size_t count, const size_t grain_size, const FuncT &func) const {
+    size_t chunk_count = std::min(thread_count_, std::max(count / std::max(grain_size, (size_t)1), (size_t)1));
+
+    if (chunk_count <= 1) {
+      if (count != 0) { func(0, count); }
+      return;
+    }
+
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < chunk_count; ++i) {
+      threads.emplace_back(func, count * i / chunk_count, count * (i + 1) / chunk_count);
+    }
+    func(0, count / chunk_count);
+
+    for (auto &thread : threads) {
+      thread.join();
+    }
+  }
+
+  // return the first offset in [begin_offset, end_offset) whose key is no less than key.
+  // return end_offset if there is no such offset.
+  size_t base_lower_bound(const KeyT &key, const size_t begin_offset, const size_t end_offset) const {
+    if (layout_type_ == StaticLayoutType::AoSLayoutType) {
+      return base_bound<false, sizeof(KeyOffsetPair)>(key, begin_offset, end_offset);
+    } else {
+      return base_bound<false, sizeof(KeyT)>(key, begin_offset, end_offset);
+    }
+  }
+
+  // return the first offset in [begin_offset, end_offset) whose key is larger than key.
+  // return end_offset if there is no such offset.
+  size_t base_upper_bound(const KeyT &key, const size_t begin_offset, const size_t end_offset) const {
+    if (layout_type_ == StaticLayoutType::AoSLayoutType) {
+      return base_bound<true, sizeof(KeyOffsetPair)>(key, begin_offset, end_offset);
+    } else {
+      return base_bound<true, sizeof(KeyT)>(key, begin_offset, end_offset);
+    }
+  }
+
+  // batched version of base_lower_bound: bounds[i] is the lower bound of keys[i] in [begin_offsets[i], end_offsets[i]).
+  void base_lower_bound_batch(const KeyT *keys, const size_t count, const size_t *begin_offsets, const size_t *end_offsets, size_t *bounds) const {
+    if (layout_type_ == StaticLayoutType::AoSLayoutType) {
+      base_bound_batch<false, sizeof(KeyOffsetPair)>(keys, count, begin_offsets, end_offsets, bounds);
+    } else {
+      base_bound_batch<false, sizeof(KeyT)>(keys, count, begin_offsets, end_offsets, bounds);
+    }
+  }
+
+  // finish a batch of point lookups whose lower bounds lie in [begin_offsets[i], end_offsets[i]],
+  // and copy the offsets of the entries matching keys[i] to offsets[i].
+  void base_find_batch(const KeyT *keys, const size_t count, const size_t *begin_offsets, const size_t *end_offsets, std::vector<Uint64> *offsets) const {
+    std::vector<size_t> bounds(count);
+    base_lower_bound_batch(keys, count, begin_offsets, end_offsets, bounds.data());
+
+    for (size_t i = 0; i < count; ++i) {
+      size_t offset_find = bounds[i];
+      while (offset_find < size_ && key_at(offset_find) == keys[i]) {
+        offsets[i].push_back(offset_at(offset_find));
+        ++offset_find;
+      }
+    }
+  }
+
+  // copy offsets of sorted entries in [begin_offset, end_offset) to the result vector.
+  void base_copy_offsets(const size_t begin_offset, const size_t end_offset, std::vector<Uint64> &offsets) const {
+    if (begin_offset >= end_offset) { return; }
+
+    offsets.reserve(offsets.size() + (end_offset - begin_offset));
+    for (size_t i = begin_offset; i < end_offset; ++i) {
+      offsets.push_back(offset_at(i));
+    }
+  }
+
+private:
+
+  // entries in [begin_offset, end_offset) match key.
+  void find_matches(const KeyT &key, size_t &begin_offset, size_t &end_offset) {
+    begin_offset = 0;
+    end_offset = 0;
+
+    if (size_ == 0) { return; }
+
+    KeyT key_min = get_key(0);
+    KeyT key_max = get_key(size_ - 1);
+
+    if (key < key_min || key > key_max) { return; }
+
+    if (key_min == key_max) {
+      end_offset = size_;
+      return;
+    }
+
+    begin_offset = find_bound(key, false);
+    end_offset = find_bound(key, true);
+  }
+
+  // whether an entry with key probe_key lies before the lower (or upper) bound of key.
+  template<bool IsUpper>
+  static bool precedes(const KeyT &probe_key, const KeyT &key) {
+    return IsUpper ? !(key < probe_key) : probe_key < key;
+  }
+
+  // iterative, branch-free binary search over keys that are KeyStride bytes apart.
+  // the bound always lies in [base, base + count]. each step halves the window
+  // with a conditional move, and prefetches the midpoints of both candidate
+  // windows of the next step so that the next probe is in flight either way.
+  // the search finishes with a linear scan once the window fits in a cacheline.
+  template<bool IsUpper, size_t KeyStride>
+  size_t base_bound(const KeyT &key, const size_t begin_offset, const size_t end_offset) const {
+    ASSERT(begin_offset <= end_offset && end_offset <= size_, 
+      "invalid range: " << begin_offset << " " << end_offset << " " << size_);
+
+    const char *base = key_base_ + begin_offset * KeyStride;
+    size_t count = end_offset - begin_offset;
+
+    while (count > CACHELINE_SIZE / KeyStride) {
+      size_t half = count / 2;
+      size_t next_half = (count - half) / 2;
+
+      __builtin_prefetch(base + next_half * KeyStride);
+      __builtin_prefetch(base + (half + next_half) * KeyStride);
+
+      base = precedes<IsUpper>(*(const KeyT*)(base + half * KeyStride), key) ? base + half * KeyStride : base;
+      count -= half;
+    }
+
+    size_t base_offset = (base - key_base_) / KeyStride;
+
+    return base_offset + count_preceding<IsUpper, KeyStride>(key, base_offset, count, std::is_same<KeyT, Uint32>());
+  }
+
+  // group prefetching version of base_bound.
+  // the binary searches of up to BATCH_GROUP_SIZE keys are advanced in lockstep:
+  // each round first issues the probes of all the searches, then compares them,
+  // so that the cache misses of a round overlap instead of forming one dependent chain.
+  template<bool IsUpper, size_t KeyStride>
+  void base_bound_batch(const KeyT *keys, const size_t count, const size_t *begin_offsets, const size_t *end_offsets, size_t *bounds) const {
+
+    const size_t window_size = CACHELINE_SIZE / KeyStride;
+
+    const char *bases[BATCH_GROUP_SIZE];
+    size_t counts[BATCH_GROUP_SIZE];
+
+    for (size_t group_begin = 0; group_begin < count; group_begin += BATCH_GROUP_SIZE) {
+      size_t group_size = std::min(BATCH_GROUP_SIZE, count - group_begin);
+
+      bool is_active = false;
+      for (size_t j = 0; j < group_size; ++j) {
+        size_t begin_offset = begin_offsets[group_begin + j];
+        size_t end_offset = end_offsets[group_begin + j];
+
+        ASSERT(begin_offset <= end_offset && end_offset <= size_, 
+          "invalid range: " << begin_offset << " " << end_offset << " " << size_);
+
+        bases[j] = key_base_ + begin_offset * KeyStride;
+        counts[j] = end_offset - begin_offset;
+        is_active |= counts[j] > window_size;
+      }
+
+      while (is_active) {
+        for (size_t j = 0; j < group_size; ++j) {
+          if (counts[j] > window_size) {
+            __builtin_prefetch(bases[j] + (counts[j] / 2) * KeyStride);
+          }
+        }
+
+        is_active = false;
+        for (size_t j = 0; j < group_size; ++j) {
+          if (counts[j] > window_size) {
+            size_t half = counts[j] / 2;
+            const KeyT &key = keys[group_begin + j];
+            bases[j] = precedes<IsUpper>(*(const KeyT*)(bases[j] + half * KeyStride), key) ? bases[j] + half * KeyStride : bases[j];
+            counts[j] -= half;
+            is_active |= counts[j] > window_size;
+          }
+        }
+      }
+
+      // fetch the remaining windows before scanning them
+      for (size_t j = 0; j < group_size; ++j) {
+        __builtin_prefetch(bases[j]);
+        __builtin_prefetch(bases[j] + (counts[j] - (counts[j] != 0)) * KeyStride);
+      }
+
+      for (size_t j = 0; j < group_size; ++j) {
+        size_t base_offset = (bases[j] - key_base_) / KeyStride;
+        bounds[group_begin + j] = base_offset + count_preceding<IsUpper, KeyStride>(keys[group_begin + j], base_offset, counts[j], std::is_same<KeyT, Uint32>());
+      }
+    }
+  }
+
+  // count the entries in [base_offset, base_offset + count) that lie before the bound.
+  template<bool IsUpper, size_t KeyStride>
+  size_t count_preceding(const KeyT &key, const size_t base_offset, const size_t count, std::false_type) const {
+    size_t ret = 0;
+    for (size_t i = 0; i < count; ++i) {
+      ret += precedes<IsUpper>(key_at(base_offset + i), key);
+    }
+    return ret;
+  }
+
+  // simd version for 4-byte keys: keys in a cacheline are compared four at a time.
+  // with key-offset pairs, a cacheline holds four entries whose keys
+  // are first gathered into one register.
+  template<bool IsUpper, size_t KeyStride>
+  size_t count_preceding(const KeyT &key, const size_t base_offset, const size_t count, std::true_type) const {
+    const size_t window_size = CACHELINE_SIZE / KeyStride;
+
+    if (count != window_size && base_offset + window_size > size_) {
+      // do not read beyond the end of the container
+      return count_preceding<IsUpper, KeyStride>(key, base_offset, count, std::false_type());
+    }
+
+    const char *base = key_base_ + base_offset * KeyStride;
+
+    // flip sign bits so that the signed comparison orders unsigned keys correctly
+    __m128i xmm_bias = _mm_set1_epi32(0x80000000);
+    __m128i xmm_key_q = _mm_xor_si128(_mm_set1_epi32(key), xmm_bias);
+
+    unsigned index = 0;
+    for (size_t i = 0; i < window_size; i += 4) {
+      __m128i xmm_keys;
+      if (KeyStride == sizeof(KeyT)) {
+        xmm_keys = _mm_loadu_si128((const __m128i*)(base + i * KeyStride));
+      } else {
+        __m128i xmm_0 = _mm_loadu_si128((const __m128i*)(base + (i + 0) * KeyStride));
+        __m128i xmm_1 = _mm_loadu_si128((const __m128i*)(base + (i + 1) * KeyStride));
+        __m128i xmm_2 = _mm_loadu_si128((const __m128i*)(base + (i + 2) * KeyStride));
+        __m128i xmm_3 = _mm_loadu_si128((const __m128i*)(base + (i + 3) * KeyStride));
+
+        // keys are the lowest 4 bytes of each entry
+        xmm_keys = _mm_unpacklo_epi64(_mm_unpacklo_epi32(xmm_0, xmm_1), _mm_unpacklo_epi32(xmm_2, xmm_3));
+      }
+      xmm_keys = _mm_xor_si128(xmm_keys, xmm_bias);
+
+      // lanes whose key precedes the bound
+      __m128i xmm_mask;
+      if (IsUpper) {
+        xmm_mask = _mm_andnot_si128(_mm_cmpgt_epi32(xmm_keys, xmm_key_q), _mm_set1_epi32(-1));
+      } else {
+        xmm_mask = _mm_cmpgt_epi32(xmm_key_q, xmm_keys);
+      }
+      index |= _mm_movemask_ps(_mm_castsi128_ps(xmm_mask)) << i;
+    }
+
+    unsigned valid_mask = (1u << count) - 1;
+    return __builtin_popcount(index & valid_mask);
+  }
+
+  // sort container_ by key.
+  // with multiple threads, a sample sort is used: entries are scattered into
+  // one bucket per thread by splitters taken from a sorted sample, and the
+  // buckets are then sorted independently.
+  void sort_container() {
+    size_t bucket_count = std::min(thread_count_, std::max(size_ / PARALLEL_GRAIN_SIZE, (size_t)1));
+
+    if (bucket_count <= 1) {
+      sort_entries(container_, nullptr, size_);
+      return;
     }
 
-    std::sort(container_, container_ + size_, compare_func);
+    // choose bucket_count - 1 splitters
+    size_t sample_count = bucket_count * SAMPLE_SORT_OVERSAMPLING;
+    std::vector<KeyT> samples(sample_count);
+    for (size_t i = 0; i < sample_count; ++i) {
+      samples[i] = container_[size_ * i / sample_count].key_;
+    }
+    std::sort(samples.begin(), samples.end());
+
+    std::vector<KeyT> splitters(bucket_count - 1);
+    for (size_t i = 0; i < bucket_count - 1; ++i) {
+      splitters[i] = samples[(i + 1) * SAMPLE_SORT_OVERSAMPLING];
+    }
+
+    auto bucket_of = [&](const KeyT &key) -> size_t {
+      return std::upper_bound(splitters.begin(), splitters.end(), key) - splitters.begin();
+    };
+
+    // the table is cut into bucket_count chunks, one per thread.
+    // bucket_sizes[i * bucket_count + j] is the number of entries in chunk i that fall in bucket j.
+    std::vector<size_t> bucket_sizes(bucket_count * bucket_count, 0);
+    parallel_for(bucket_count, 1, [&](const size_t begin_chunk, const size_t end_chunk) {
+      for (size_t i = begin_chunk; i < end_chunk; ++i) {
+        size_t *sizes = &bucket_sizes[i * bucket_count];
+        for (size_t pos = size_ * i / bucket_count; pos < size_ * (i + 1) / bucket_count; ++pos) {
+          ++sizes[bucket_of(container_[pos].key_)];
+        }
+      }
+    });
+
+    // bucket_cursors[i * bucket_count + j] is where chunk i starts writing into bucket j
+    std::vector<size_t> bucket_cursors(bucket_count * bucket_count, 0);
+    std::vector<size_t> bucket_begins(bucket_count + 1, 0);
+    size_t cursor = 0;
+    for (size_t j = 0; j < bucket_count; ++j) {
+      bucket_begins[j] = cursor;
+      for (size_t i = 0; i < bucket_count; ++i) {
+        bucket_cursors[i * bucket_count + j] = cursor;
+        cursor += bucket_sizes[i * bucket_count + j];
+      }
+    }
+    bucket_begins[bucket_count] = cursor;
+
+    KeyOffsetPair *buffer = allocate_array<KeyOffsetPair>(size_);
+
+    parallel_for(bucket_count, 1, [&](const size_t begin_chunk, const size_t end_chunk) {
+      for (size_t i = begin_chunk; i < end_chunk; ++i) {
+        size_t *cursors = &bucket_cursors[i * bucket_count];
+        for (size_t pos = size_ * i / bucket_count; pos < size_ * (i + 1) / bucket_count; ++pos) {
+          buffer[cursors[bucket_of(container_[pos].key_)]++] = container_[pos];
+        }
+      }
+    });
+
+    // the old container is no longer needed and serves as scratch space
+    parallel_for(bucket_count, 1, [&](const size_t begin_bucket, const size_t end_bucket) {
+      for (size_t j = begin_bucket; j < end_bucket; ++j) {
+        sort_entries(buffer + bucket_begins[j], container_ + bucket_begins[j], bucket_begins[j + 1] - bucket_begins[j]);
+      }
+    });
+
+    free_array(container_);
+    container_ = buffer;
+  }
+
+  // sort count entries by key. scratch must have room for count entries, or be
+  // nullptr, in which case the radix sort allocates its own.
+  void sort_entries(KeyOffsetPair *entries, KeyOffsetPair *scratch, const size_t count) const {
+    sort_entries(entries, scratch, count, std::integral_constant<bool, std::is_integral<KeyT>::value && std::is_unsigned<KeyT>::value>());
+  }
+
+  void sort_entries(KeyOffsetPair *entries, KeyOffsetPair *scratch, const size_t count, std::false_type) const {
+    std::sort(entries, entries + count, compare_func);
+  }
+
+  // least significant digit radix sort for unsigned integer keys.
+  // the histograms of all digits are built in a single pass, and a pass is
+  // skipped if all entries share its digit, e.g., the high bytes of small keys.
+  void sort_entries(KeyOffsetPair *entries, KeyOffsetPair *scratch, const size_t count, std::true_type) const {
+    if (count < RADIX_SORT_THRESHOLD) {
+      std::sort(entries, entries + count, compare_func);
+      return;
+    }
+
+    KeyOffsetPair *own_scratch = nullptr;
+    if (scratch == nullptr) {
+      own_scratch = allocate_array<KeyOffsetPair>(count);
+      scratch = own_scratch;
+    }
 
+    const size_t digit_count = sizeof(KeyT) * 8 / RADIX_BITS;
+
+    size_t histograms[sizeof(KeyT) * 8 / RADIX_BITS][RADIX_SIZE];
+    memset(histograms, 0, sizeof(histograms));
+
+    for (size_t i = 0; i < count; ++i) {
+      KeyT key = entries[i].key_;
+      for (size_t d = 0; d < digit_count; ++d) {
+        ++histograms[d][(key >> (d * RADIX_BITS)) & (RADIX_SIZE - 1)];
+      }
+    }
+
+    KeyOffsetPair *src = entries;
+    KeyOffsetPair *dst = scratch;
+
+    for (size_t d = 0; d < digit_count; ++d) {
+      size_t shift = d * RADIX_BITS;
+      size_t *histogram = histograms[d];
+
+      if (histogram[(src[0].key_ >> shift) & (RADIX_SIZE - 1)] == count) {
+        // constant digit
+        continue;
+      }
+
+      // turn counts into output positions
+      size_t position = 0;
+      for (size_t i = 0; i < RADIX_SIZE; ++i) {
+        size_t digit_size = histogram[i];
+        histogram[i] = position;
+        position += digit_size;
+      }
+
+      for (size_t i = 0; i < count; ++i) {
+        dst[histogram[(src[i].key_ >> shift) & (RADIX_SIZE - 1)]++] = src[i];
+      }
+
+      std::swap(src, dst);
+    }
+
+    if (src != entries) {
+      memcpy(entries, src, sizeof(KeyOffsetPair) * count);
+    }
+
+    free_array(own_scratch);
   }
 
 protected:
 
+  StaticLayoutType layout_type_;
+
+  // sorted entries in AoSLayoutType
   KeyOffsetPair *container_;
+
+  // sorted entries in SoALayoutType
+  KeyT *keys_;
+  Uint64 *offsets_;
+
+  // entries are accessed through these in both layouts
+  const char *key_base_;
+  const char *offset_base_;
+  size_t key_stride_;
+  size_t offset_stride_;
+
   size_t size_;
 
+  // number of threads used by reorganize()
+  size_t thread_count_;
+
+  // how arrays allocated by reorganize() are backed
+  StaticAllocationType allocation_type_;
+
+  // sorted entries read by reorganize() in place of the table, if not null
+  const std::vector<std::pair<KeyT, Uint64>> *source_entries_;
+
 };
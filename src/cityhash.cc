@@ -513,7 +513,7 @@ uint128 CityHash128(const char *s, size_t len) {
 }
 
 #ifdef __SSE4_2__
-#include <citycrc.h>
+#include "citycrc.h"
 #include <nmmintrin.h>
 
 // Requires len >= 240.
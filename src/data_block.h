@@ -1,28 +1,65 @@
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <cstring>
+#include <string>
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <linux/mempolicy.h>
 
 #include "offset.h"
 
-const uint64_t MaxBlockCapacity = 1000;
+// number of tuples per block, a power of two
+const uint64_t MaxBlockCapacity = 1ull << 16;
+
+// where the pages of a data block are placed on a NUMA machine.
+enum class BlockPlacementType {
+  // pages are placed on the node of the first thread touching them
+  FirstTouchPlacementType = 0,
+  // pages are placed on the node of the thread creating the block
+  LocalNodePlacementType,
+};
+
+static std::string get_block_placement_name(const BlockPlacementType placement_type) {
+  if (placement_type == BlockPlacementType::FirstTouchPlacementType) {
+    return "first touch";
+  } else {
+    return "local node";
+  }
+}
 
 class DataBlock {
 
   public:
-    DataBlock(const BlockIDT block_id, const size_t tuple_size, const uint64_t max_block_capacity) : 
+    // a block holds max_block_capacity tuple slots of tuple_size bytes,
+    // followed by a heap of heap_size bytes for variable-length data.
+    DataBlock(const BlockIDT block_id, const size_t tuple_size, const uint64_t max_block_capacity, const BlockPlacementType placement_type, const size_t heap_size = 0) : 
+      max_rel_offset_(max_block_capacity),
       block_id_(block_id),
-      tuple_size_(tuple_size), 
-      max_rel_offset_(max_block_capacity) {
+      tuple_size_(tuple_size),
+      heap_size_(heap_size) {
       
       next_rel_offset_ = 0;
-
-      tuples_ = new char[tuple_size_ * max_rel_offset_];
-      memset(tuples_, 0, tuple_size_ * max_rel_offset_);
+      next_heap_offset_ = 0;
+
+      // anonymous pages read as zero, so the block needs no zero-fill,
+      // and a page is only backed by memory once a tuple is written to it.
+      // the heap may be sized for the worst case, so swap is not reserved for it.
+      tuples_size_ = tuple_size_ * max_rel_offset_;
+      void *tuples = mmap(nullptr, tuples_size_ + heap_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+      ASSERT(tuples != MAP_FAILED, "failed to allocate data block: " << tuples_size_ + heap_size_);
+      tuples_ = (char*)tuples;
+
+      if (placement_type == BlockPlacementType::LocalNodePlacementType) {
+        bind_to_local_node();
+      }
     }
 
     ~DataBlock() {
-      delete[] tuples_;
+      munmap(tuples_, tuples_size_ + heap_size_);
       tuples_ = nullptr;
     }
 
@@ -40,6 +77,22 @@ class DataBlock {
       return tuples_ + rel_offset * tuple_size_;
     }
 
+    // start of the block memory, for tables laying out tuples themselves
+    char* get_data() const {
+      return tuples_;
+    }
+
+    // reserve size bytes in the heap, and set heap_offset to their offset.
+    char* reserve_heap(const size_t size, size_t &heap_offset) {
+      heap_offset = next_heap_offset_.fetch_add(size);
+      ASSERT(heap_offset + size <= heap_size_, "exceed heap size: " << heap_offset + size << " " << heap_size_);
+      return tuples_ + tuples_size_ + heap_offset;
+    }
+
+    char* get_heap_data(const size_t heap_offset) const {
+      return tuples_ + tuples_size_ + heap_offset;
+    }
+
     BlockIDT get_block_id() const {
       return block_id_;
     }
@@ -48,14 +101,28 @@ class DataBlock {
       return max_rel_offset_;
     }
 
+    // number of reserved slots. the slot counter overshoots once the block is full.
     size_t size() const {
-      return next_rel_offset_;
+      return std::min(next_rel_offset_.load(), max_rel_offset_);
     }
 
   private:
     DataBlock(const DataBlock &);
     DataBlock& operator=(const DataBlock &);
 
+    // prefer the node of the calling thread for the pages of the block.
+    // this is a hint: without NUMA support, pages are placed as usual.
+    void bind_to_local_node() {
+      unsigned cpu = 0;
+      unsigned node = 0;
+      if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0 || node >= sizeof(unsigned long) * 8) {
+        return;
+      }
+      unsigned long node_mask = 1ul << node;
+      // the kernel ignores the last bit of the mask size
+      syscall(SYS_mbind, tuples_, tuples_size_ + heap_size_, MPOL_PREFERRED, &node_mask, sizeof(node_mask) * 8 + 1, 0);
+    }
+
   private:
     const RelOffsetT max_rel_offset_;
     
@@ -65,4 +132,8 @@ class DataBlock {
 
     size_t tuple_size_;
     char *tuples_;
+    size_t tuples_size_;
+
+    size_t heap_size_;
+    std::atomic<size_t> next_heap_offset_;
 };
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <atomic>
+
+#include "data_block.h"
+
+// process-wide number of the calling thread, assigned on first use.
+inline size_t get_thread_number() {
+  static std::atomic<size_t> thread_count(0);
+  static thread_local size_t thread_number = thread_count.fetch_add(1);
+  return thread_number;
+}
+
+// lock-free directory of the data blocks of a table.
+// block ids are handed out by a single counter, and each block is published in a
+// pre-sized two-level directory, so readers never race with a resizing container.
+// each thread appends to its own active block, so concurrent inserts do not contend
+// on one slot counter. blocks are filled by their threads at different paces, so
+// any block, not only the last one, may be partially filled.
+class DataBlockDirectory {
+
+  // the directory holds up to SEGMENT_COUNT segments of SEGMENT_SIZE blocks
+  static const size_t SEGMENT_BITS = 14;
+  static const size_t SEGMENT_SIZE = 1ull << SEGMENT_BITS;
+  static const size_t SEGMENT_COUNT = 1ull << 14;
+
+  // threads are spread over this many active blocks
+  static const size_t ACTIVE_BLOCK_COUNT = 64;
+
+  static const size_t CACHELINE_SIZE = 64; // unit: byte
+
+  // active blocks are a cacheline apart, so that threads do not share lines
+  struct ActiveBlock {
+    ActiveBlock() : block_(nullptr) {}
+
+    std::atomic<DataBlock*> block_;
+    char padding_[CACHELINE_SIZE - sizeof(std::atomic<DataBlock*>)];
+  };
+
+public:
+  // blocks get a heap of heap_size bytes, if not 0. see DataBlock.
+  DataBlockDirectory(const size_t tuple_size, const uint64_t max_block_capacity, const BlockPlacementType placement_type, const size_t heap_size = 0) :
+    tuple_size_(tuple_size),
+    heap_size_(heap_size),
+    max_block_capacity_(max_block_capacity),
+    block_capacity_bits_(0),
+    placement_type_(placement_type),
+    next_block_id_(0) {
+
+    ASSERT(max_block_capacity_ >= 1 && (max_block_capacity_ & (max_block_capacity_ - 1)) == 0, "block capacity must be a power of two: " << max_block_capacity_);
+    ASSERT(max_block_capacity_ <= (1ull << BLOCKOFFSET_BITS), "exceed maximum block capacity: " << max_block_capacity_);
+
+    while ((1ull << block_capacity_bits_) < max_block_capacity_) {
+      ++block_capacity_bits_;
+    }
+
+    segments_ = new std::atomic<std::atomic<DataBlock*>*>[SEGMENT_COUNT]();
+  }
+
+  ~DataBlockDirectory() {
+    BlockIDT block_count = get_block_count();
+    for (BlockIDT block_id = 0; block_id < block_count; ++block_id) {
+      delete get_block(block_id);
+    }
+    for (size_t i = 0; i < SEGMENT_COUNT; ++i) {
+      delete[] segments_[i].load();
+    }
+    delete[] segments_;
+    segments_ = nullptr;
+  }
+
+  // reserve a tuple slot in the active block of the calling thread.
+  OffsetT reserve_slot(DataBlock *&block) {
+
+    ActiveBlock &active_block = active_blocks_[get_thread_number() % ACTIVE_BLOCK_COUNT];
+
+    while (true) {
+      DataBlock *curr_block = active_block.block_.load(std::memory_order_acquire);
+
+      if (curr_block != nullptr) {
+        RelOffsetT rel_offset = curr_block->get_next_rel_offset();
+
+        if (rel_offset != INVALID_OFFSET) {
+          block = curr_block;
+          return OffsetT(curr_block->get_block_id(), rel_offset);
+        }
+      }
+
+      // the active block is full. threads sharing it may each add a block,
+      // and the blocks that lose the race are left empty.
+      DataBlock *new_block = add_block();
+      active_block.block_.compare_exchange_strong(curr_block, new_block);
+    }
+  }
+
+  // return nullptr if the block is not published yet.
+  DataBlock* get_block(const BlockIDT block_id) const {
+    std::atomic<DataBlock*> *segment = segments_[block_id >> SEGMENT_BITS].load(std::memory_order_acquire);
+    if (segment == nullptr) {
+      return nullptr;
+    }
+    return segment[block_id & (SEGMENT_SIZE - 1)].load(std::memory_order_acquire);
+  }
+
+  // number of block ids handed out so far
+  BlockIDT get_block_count() const {
+    return next_block_id_.load(std::memory_order_acquire);
+  }
+
+  // number of tuples in a block
+  size_t get_block_size(const BlockIDT block_id) const {
+    DataBlock *block = get_block(block_id);
+    return (block == nullptr) ? 0 : block->size();
+  }
+
+  uint64_t get_max_block_capacity() const {
+    return max_block_capacity_;
+  }
+
+  // number of tuple slots in all blocks
+  size_t capacity() const {
+    return (size_t)get_block_count() << block_capacity_bits_;
+  }
+
+  BlockPlacementType get_placement_type() const {
+    return placement_type_;
+  }
+
+  size_t size() const {
+    size_t count = 0;
+    BlockIDT block_count = get_block_count();
+    for (BlockIDT block_id = 0; block_id < block_count; ++block_id) {
+      count += get_block_size(block_id);
+    }
+    return count;
+  }
+
+private:
+  DataBlockDirectory(const DataBlockDirectory &);
+  DataBlockDirectory& operator=(const DataBlockDirectory &);
+
+  DataBlock* add_block() {
+    BlockIDT block_id = next_block_id_.fetch_add(1);
+
+    ASSERT(block_id < SEGMENT_COUNT * SEGMENT_SIZE, "exceed maximum number of blocks");
+
+    std::atomic<std::atomic<DataBlock*>*> &segment_slot = segments_[block_id >> SEGMENT_BITS];
+    std::atomic<DataBlock*> *segment = segment_slot.load(std::memory_order_acquire);
+
+    if (segment == nullptr) {
+      std::atomic<DataBlock*> *new_segment = new std::atomic<DataBlock*>[SEGMENT_SIZE]();
+      if (segment_slot.compare_exchange_strong(segment, new_segment)) {
+        segment = new_segment;
+      } else {
+        delete[] new_segment;
+      }
+    }
+
+    DataBlock *block = new DataBlock(block_id, tuple_size_, max_block_capacity_, placement_type_, heap_size_);
+    segment[block_id & (SEGMENT_SIZE - 1)].store(block, std::memory_order_release);
+    return block;
+  }
+
+private:
+  size_t tuple_size_;
+  size_t heap_size_;
+  uint64_t max_block_capacity_;
+  size_t block_capacity_bits_;
+
+  BlockPlacementType placement_type_;
+
+  std::atomic<BlockIDT> next_block_id_;
+
+  // first level of the directory
+  std::atomic<std::atomic<DataBlock*>*> *segments_;
+
+  ActiveBlock active_blocks_[ACTIVE_BLOCK_COUNT];
+};
@@ -3,105 +3,112 @@
 #include <cassert>
 #include <vector>
 
-#include "data_block.h"
+#include "data_block_directory.h"
 
-template<typename KeyT, typename ValueT>
-class DataTableIterator;
+enum class TableLayoutType {
+  // keys and values interleaved tuple by tuple
+  RowLayoutType = 0,
+  // within a block, all keys followed by all values
+  ColumnLayoutType,
+};
+
+static std::string get_table_layout_name(const TableLayoutType layout_type) {
+  if (layout_type == TableLayoutType::RowLayoutType) {
+    return "row";
+  } else {
+    return "column";
+  }
+}
 
 template<typename KeyT, typename ValueT>
 class DataTable {
 
-  friend DataTableIterator<KeyT, ValueT>;
-
 public:
-  DataTable(const uint64_t max_block_capacity = MaxBlockCapacity) {
+  DataTable(const uint64_t max_block_capacity = MaxBlockCapacity, const BlockPlacementType placement_type = BlockPlacementType::FirstTouchPlacementType, const TableLayoutType layout_type = TableLayoutType::RowLayoutType) :
+    data_blocks_(sizeof(KeyT) + sizeof(ValueT), max_block_capacity, placement_type),
+    layout_type_(layout_type),
+    value_column_begin_(sizeof(KeyT) * max_block_capacity) {}
 
-    max_block_capacity_ = max_block_capacity;
-
-    data_blocks_.emplace_back(new DataBlock(0, sizeof(KeyT) + sizeof(ValueT), max_block_capacity_));
-    active_data_block_ = data_blocks_.at(0);
-  }
-  
-  ~DataTable() {
-    for (auto entry : data_blocks_) {
-      delete entry;
-      entry = nullptr;
-    }
-  }
+  ~DataTable() {}
 
+  // threads insert into their own blocks, so inserts only share the block id counter.
   OffsetT insert_tuple(const KeyT &key, const ValueT &value) {
 
-    while (true) {
-      DataBlock* tmp_block = active_data_block_;
-
-      RelOffsetT rel_offset = tmp_block->get_next_rel_offset();
-
-      if (rel_offset != INVALID_OFFSET) {
-        
-        OffsetT tuple_offset(tmp_block->get_block_id(), rel_offset);
-
-        // copy data.
-        char* data = tmp_block->get_tuple(rel_offset);
-        memcpy(data, &key, sizeof(key));
-        memcpy(data + sizeof(key), &value, sizeof(ValueT));
+    DataBlock *block = nullptr;
+    OffsetT tuple_offset = data_blocks_.reserve_slot(block);
 
-        if (rel_offset == tmp_block->get_max_rel_offset() - 1) {
-          auto new_block = new DataBlock(tmp_block->get_block_id() + 1, sizeof(KeyT) + sizeof(ValueT), max_block_capacity_);
-          data_blocks_.emplace_back(new_block);
+    // copy data.
+    memcpy(get_key(block, tuple_offset.rel_offset()), &key, sizeof(key));
+    memcpy(get_value(block, tuple_offset.rel_offset()), &value, sizeof(ValueT));
 
-          COMPILER_MEMORY_FENCE;
-
-          active_data_block_ = new_block;
-        }
-
-        return tuple_offset;
-      }
-    }
+    return tuple_offset;
   }
 
   KeyT* get_tuple_key(const BlockIDT block_id, const RelOffsetT rel_offset) const {
-
-    char *data = data_blocks_.at(block_id)->get_tuple(rel_offset);
-    return (KeyT*)(data);
+    return get_key(data_blocks_.get_block(block_id), rel_offset);
   }
 
   ValueT* get_tuple_value(const BlockIDT block_id, const RelOffsetT rel_offset) const {
-
-    char *data = data_blocks_.at(block_id)->get_tuple(rel_offset);
-    return (ValueT*)(data + sizeof(KeyT));
+    return get_value(data_blocks_.get_block(block_id), rel_offset);
   }
 
   KeyT* get_tuple_key(const OffsetT offset) const {
-
-    char *data = data_blocks_.at(offset.block_id())->get_tuple(offset.rel_offset());
-    return (KeyT*)(data);
+    return get_key(data_blocks_.get_block(offset.block_id()), offset.rel_offset());
   }
 
   ValueT* get_tuple_value(const OffsetT offset) const {
-
-    char *data = data_blocks_.at(offset.block_id())->get_tuple(offset.rel_offset());
-    return (ValueT*)(data + sizeof(KeyT));
+    return get_value(data_blocks_.get_block(offset.block_id()), offset.rel_offset());
   }
 
+  // blocks may be partially filled, so tuples are counted block by block.
   size_t size() const {
-    ASSERT(data_blocks_.size() != 0, "must have at least one data block");
-    if (data_blocks_.size() == 1) {
-      return data_blocks_.at(0)->size();
-    } else {
-      return (data_blocks_.size() - 1) * max_block_capacity_ + data_blocks_.at(data_blocks_.size() - 1)->size();
-    }
+    return data_blocks_.size();
   }
 
   // approximate data table size
   size_t size_approx() const {
-    assert(data_blocks_.size() != 0);
-    return data_blocks_.size() * max_block_capacity_;
+    return data_blocks_.capacity();
+  }
+
+  BlockIDT get_block_count() const {
+    return data_blocks_.get_block_count();
+  }
+
+  size_t get_block_size(const BlockIDT block_id) const {
+    return data_blocks_.get_block_size(block_id);
+  }
+
+  uint64_t get_max_block_capacity() const {
+    return data_blocks_.get_max_block_capacity();
+  }
+
+  TableLayoutType get_layout_type() const {
+    return layout_type_;
   }
 
 private:
-  uint64_t max_block_capacity_;
-  std::vector<DataBlock*> data_blocks_;
-  DataBlock* active_data_block_;
+  KeyT* get_key(const DataBlock *block, const RelOffsetT rel_offset) const {
+    if (layout_type_ == TableLayoutType::RowLayoutType) {
+      return (KeyT*)(block->get_tuple(rel_offset));
+    }
+    ASSERT(rel_offset < block->get_max_rel_offset(), "wrong offset: " << rel_offset << " " << block->get_max_rel_offset());
+    return (KeyT*)(block->get_data()) + rel_offset;
+  }
+
+  ValueT* get_value(const DataBlock *block, const RelOffsetT rel_offset) const {
+    if (layout_type_ == TableLayoutType::RowLayoutType) {
+      return (ValueT*)(block->get_tuple(rel_offset) + sizeof(KeyT));
+    }
+    ASSERT(rel_offset < block->get_max_rel_offset(), "wrong offset: " << rel_offset << " " << block->get_max_rel_offset());
+    return (ValueT*)(block->get_data() + value_column_begin_) + rel_offset;
+  }
+
+private:
+  DataBlockDirectory data_blocks_;
+
+  TableLayoutType layout_type_;
+  // byte offset of the value column in a block
+  size_t value_column_begin_;
 
 };
 
@@ -110,7 +117,7 @@ class DataTableIterator {
 
 public:
   struct IteratorEntry {
-    IteratorEntry(const BlockIDT block_id, const RelOffsetT rel_offset, KeyT *key, ValueT *value) : 
+    IteratorEntry(const BlockIDT block_id, const RelOffsetT rel_offset, KeyT *key, ValueT *value) :
       offset_(OffsetT::construct_raw_data(block_id, rel_offset)), key_(key), value_(value) {}
 
     Uint64 offset_;
@@ -119,54 +126,80 @@ public:
   };
 
 public:
-  DataTableIterator(DataTable<KeyT, ValueT> *table_ptr) : 
+  DataTableIterator(DataTable<KeyT, ValueT> *table_ptr) :
     table_ptr_(table_ptr), curr_block_id_(0), curr_rel_offset_(0) {
-    
-    ASSERT(table_ptr_->data_blocks_.size() != 0, "table must contain at least one data block!");
-    ASSERT(!(table_ptr_->data_blocks_.size() == 1 && table_ptr_->data_blocks_.at(0)->size() == 0), "table must contain at least one tuple!");
 
-    max_rel_offset_ = table_ptr_->max_block_capacity_ - 1; 
+    end_block_id_ = table_ptr_->get_block_count();
+    curr_block_size_ = (curr_block_id_ < end_block_id_) ? table_ptr_->get_block_size(curr_block_id_) : 0;
 
-    last_block_id_ = table_ptr_->data_blocks_.size() - 1;
+    skip_visited_blocks();
+  }
 
-    size_t last_block_size = table_ptr_->data_blocks_.at(last_block_id_)->size();
-    if (last_block_size == 0) {
-      last_rel_offset_ = max_rel_offset_;
-      last_block_id_ = last_block_id_ - 1;
-    } else {
-      last_rel_offset_ = last_block_size - 1;
-    }
+  // iterate over the tuples in blocks [begin_block_id, end_block_id).
+  // disjoint ranges can be iterated concurrently.
+  DataTableIterator(DataTable<KeyT, ValueT> *table_ptr, const BlockIDT begin_block_id, const BlockIDT end_block_id) :
+    table_ptr_(table_ptr), curr_block_id_(begin_block_id), curr_rel_offset_(0), end_block_id_(end_block_id) {
+
+    ASSERT(begin_block_id <= end_block_id && end_block_id <= table_ptr_->get_block_count(), "invalid range: " << begin_block_id << " " << end_block_id);
+
+    curr_block_size_ = (curr_block_id_ < end_block_id_) ? table_ptr_->get_block_size(curr_block_id_) : 0;
+
+    skip_visited_blocks();
   }
 
   bool has_next() const {
-    if (curr_block_id_ > last_block_id_ || (curr_block_id_ == last_block_id_ && curr_rel_offset_ > last_rel_offset_)) {
-      return false;
-    } else {
-      return true;
-    }
+    return curr_block_id_ < end_block_id_;
   }
 
   IteratorEntry next() {
     BlockIDT ret_block_id = curr_block_id_;
     RelOffsetT ret_rel_offset = curr_rel_offset_;
 
-    if (curr_rel_offset_ != max_rel_offset_) {
-      curr_rel_offset_++;
-    } else {
+    curr_rel_offset_++;
+    skip_visited_blocks();
+
+    return IteratorEntry(ret_block_id, ret_rel_offset, table_ptr_->get_tuple_key(ret_block_id, ret_rel_offset), table_ptr_->get_tuple_value(ret_block_id, ret_rel_offset));
+  }
+
+  // key-only streaming: return the key of the next tuple, and set offset to its offset.
+  // with the column layout, keys are read back to back and values are never touched.
+  const KeyT& next_key(Uint64 &offset) {
+    offset = OffsetT::construct_raw_data(curr_block_id_, curr_rel_offset_);
+    KeyT *key = table_ptr_->get_tuple_key(curr_block_id_, curr_rel_offset_);
+
+    curr_rel_offset_++;
+    skip_visited_blocks();
+
+    return *key;
+  }
+
+  // value-only streaming, see next_key().
+  const ValueT& next_value(Uint64 &offset) {
+    offset = OffsetT::construct_raw_data(curr_block_id_, curr_rel_offset_);
+    ValueT *value = table_ptr_->get_tuple_value(curr_block_id_, curr_rel_offset_);
+
+    curr_rel_offset_++;
+    skip_visited_blocks();
+
+    return *value;
+  }
+
+private:
+  // move past the blocks whose tuples are all visited, as well as empty blocks.
+  void skip_visited_blocks() {
+    while (curr_block_id_ < end_block_id_ && curr_rel_offset_ >= curr_block_size_) {
       curr_block_id_++;
       curr_rel_offset_ = 0;
+      curr_block_size_ = (curr_block_id_ < end_block_id_) ? table_ptr_->get_block_size(curr_block_id_) : 0;
     }
-    return IteratorEntry(ret_block_id, ret_rel_offset, table_ptr_->get_tuple_key(ret_block_id, ret_rel_offset), table_ptr_->get_tuple_value(ret_block_id, ret_rel_offset));
   }
 
-
 private:
   DataTable<KeyT, ValueT> *table_ptr_;
 
   BlockIDT curr_block_id_;
   RelOffsetT curr_rel_offset_;
+  size_t curr_block_size_;
 
-  BlockIDT last_block_id_;
-  RelOffsetT last_rel_offset_;
-  RelOffsetT max_rel_offset_;
+  BlockIDT end_block_id_;
 };
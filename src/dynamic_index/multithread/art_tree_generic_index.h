@@ -17,13 +17,11 @@ static void load_key_internal(void *ctx, TID tid, art::Key &tree_key) {
 
   auto data_table_ptr = reinterpret_cast<GenericDataTable*>(ctx);  
 
-  char *key_ptr = data_table_ptr->get_tuple_key(OffsetT(tid));
+  // the table keeps the size of every key, so keys may hold any byte, including zero.
+  TupleView key_view = data_table_ptr->get_tuple_key(OffsetT(tid));
 
-  size_t key_len = strlen(key_ptr);
-  size_t max_key_size = data_table_ptr->get_max_key_size();
-  if (key_len > max_key_size) {
-    key_len = max_key_size;
-  }
+  char *key_ptr = key_view.raw();
+  size_t key_len = key_view.size();
 
   tree_key.setKeyLen(key_len);
 
@@ -48,7 +46,7 @@ public:
     bool rt = container_.insert(tree_key, offset, ti_);
   }
 
-  virtual void find(const GenericKey &key, std::vector<Uint64> &offsets) final {
+  virtual void find(const GenericKeyView &key, std::vector<Uint64> &offsets) final {
 
     art::Key tree_key;
     load_key(key, tree_key);
@@ -96,7 +94,7 @@ public:
   }
 
 private:
-  void load_key(const GenericKey &key, art::Key &tree_key) {
+  void load_key(const GenericKeyView &key, art::Key &tree_key) {
     tree_key.setKeyLen(key.size());
 
     uint8_t *tree_key_data = &(tree_key[0]);
@@ -14,7 +14,7 @@ class BwTreeGenericIndex : public BaseDynamicGenericIndex {
 
 public:
   BwTreeGenericIndex(GenericDataTable *table_ptr) : BaseDynamicGenericIndex(table_ptr) {
-    container_ = new BwTree<GenericKey, Uint64, GenericKeyComparator, GenericKeyEqualityChecker, GenericKeyHasher>{true};
+    container_ = new BwTree<GenericKey, Uint64, GenericKeyComparator, GenericKeyEqualityChecker, GenericKeyHasher<>>{true};
   }
 
   virtual ~BwTreeGenericIndex() {
@@ -36,8 +36,8 @@ public:
     container_->Insert(key, offset);
   }
 
-  virtual void find(const GenericKey &key, std::vector<Uint64> &offsets) final {
-    container_->GetValue(key, offsets);
+  virtual void find(const GenericKeyView &key, std::vector<Uint64> &offsets) final {
+    container_->GetValue(GenericKey::borrow(key), offsets);
   }
 
   virtual void find_range(const GenericKey &lhs_key, const GenericKey &rhs_key, std::vector<Uint64> &offsets) final {
@@ -64,7 +64,7 @@ public:
   }
 
 private:
-  BwTree<GenericKey, Uint64, GenericKeyComparator, GenericKeyEqualityChecker, GenericKeyHasher> *container_;
+  BwTree<GenericKey, Uint64, GenericKeyComparator, GenericKeyEqualityChecker, GenericKeyHasher<>> *container_;
   size_t thread_count_;
 };
 
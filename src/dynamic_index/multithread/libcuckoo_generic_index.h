@@ -7,6 +7,8 @@
 namespace dynamic_index {
 namespace multithread {
 
+// keys are hashed by HasherT, see key_hasher.h
+template<typename HasherT = DefaultHasher>
 class LibcuckooGenericIndex : public BaseDynamicGenericIndex {
 
 public:
@@ -18,8 +20,8 @@ public:
     container_.upsert(key, [&offset](std::vector<Uint64>& vec) { vec.push_back(offset); }, 1, offset);
   }
 
-  virtual void find(const GenericKey &key, std::vector<Uint64> &offsets) final {
-    container_.find(key, offsets);
+  virtual void find(const GenericKeyView &key, std::vector<Uint64> &offsets) final {
+    container_.find(GenericKey::borrow(key), offsets);
   }
 
   virtual void find_range(const GenericKey &lhs_key, const GenericKey &rhs_key, std::vector<Uint64> &offsets) final {
@@ -35,7 +37,7 @@ public:
   }
 
 private:
-  cuckoohash_map<GenericKey, std::vector<Uint64>, GenericKeyHasher> container_;
+  cuckoohash_map<GenericKey, std::vector<Uint64>, GenericKeyHasher<HasherT>> container_;
 };
 
 }
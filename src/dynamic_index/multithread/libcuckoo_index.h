@@ -2,13 +2,16 @@
 
 #include "libcuckoo/cuckoohash_map.hh"
 
+#include "key_hasher.h"
+
 #include "base_dynamic_index.h"
 
 
 namespace dynamic_index {
 namespace multithread {
 
-template<typename KeyT, typename ValueT>
+// keys are hashed by HasherT, see key_hasher.h
+template<typename KeyT, typename ValueT, typename HasherT = DefaultHasher>
 class LibcuckooIndex : public BaseDynamicIndex<KeyT, ValueT> {
 
 public:
@@ -37,7 +40,7 @@ public:
   }
 
 private:
-  cuckoohash_map<KeyT, std::vector<Uint64>> container_;
+  cuckoohash_map<KeyT, std::vector<Uint64>, NumericKeyHasher<KeyT, HasherT>> container_;
 };
 
 }
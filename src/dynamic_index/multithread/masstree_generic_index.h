@@ -70,7 +70,7 @@ public:
 
   }
 
-  virtual void find(const GenericKey &key, std::vector<Uint64> &offsets) final {
+  virtual void find(const GenericKeyView &key, std::vector<Uint64> &offsets) final {
 
     Str value;
     typename Masstree::default_table::unlocked_cursor_type lp(container_->table(), key.raw(), key.size());
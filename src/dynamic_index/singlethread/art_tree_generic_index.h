@@ -22,7 +22,7 @@ public:
     art_insert(&container_, (unsigned char*)(key.raw()), key.size(), offset);
   }
 
-  virtual void find(const GenericKey &key, std::vector<Uint64> &offsets) final {
+  virtual void find(const GenericKeyView &key, std::vector<Uint64> &offsets) final {
     art_search(&container_, (unsigned char*)(key.raw()), key.size(), offsets);
   }
 
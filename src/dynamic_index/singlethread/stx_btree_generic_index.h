@@ -17,11 +17,11 @@ public:
 
   virtual void insert(const GenericKey &key, const Uint64 &offset) final {
 
-    container_.insert(std::pair<GenericKey, Uint64>(key, offset));
+    container_.insert(key, offset);
   }
 
-  virtual void find(const GenericKey &key, std::vector<Uint64> &offsets) final {
-    auto ret = container_.equal_range(key);
+  virtual void find(const GenericKeyView &key, std::vector<Uint64> &offsets) final {
+    auto ret = container_.equal_range(GenericKey::borrow(key));
     for (auto iter = ret.first; iter != ret.second; ++iter) {
       offsets.push_back(iter->second);
     }
@@ -1,89 +1,93 @@
 #pragma once
 
 #include <cassert>
+#include <limits>
 #include <vector>
 
-#include "data_block.h"
+#include "data_block_directory.h"
 
-class GenericDataTableIterator;
+// non-owning view of the key or the value of a tuple in a table.
+struct TupleView {
 
+  TupleView(char *data, const size_t size) : data_(data), size_(size) {}
+
+  inline char* raw() const { return data_; }
+
+  inline size_t size() const { return size_; }
+
+  char *data_;
+  size_t size_;
+};
+
+// table of variable-length tuples.
+// a block holds a slot per tuple, and packs the key and value bytes of its
+// tuples back to back in the heap of the block. a slot records where the bytes
+// of its tuple start in the heap, and the sizes of the key and the value.
+// the heap of a block is sized for tuples of max_key_size_ and max_value_size_
+// bytes, but only the pages holding actual bytes are backed by memory.
 class GenericDataTable {
 
-  friend GenericDataTableIterator;
+  struct TupleSlot {
+    // offset of the key in the heap. the value follows the key.
+    uint64_t heap_offset_;
+    uint32_t key_size_;
+    uint32_t value_size_;
+  };
 
 public:
-  GenericDataTable(const uint64_t max_key_size, const uint64_t max_value_size, const uint64_t max_block_capacity = MaxBlockCapacity) {
-
-    max_key_size_ = max_key_size;
-    max_value_size_ = max_value_size;
-    max_block_capacity_ = max_block_capacity;
+  GenericDataTable(const uint64_t max_key_size, const uint64_t max_value_size, const uint64_t max_block_capacity = MaxBlockCapacity, const BlockPlacementType placement_type = BlockPlacementType::FirstTouchPlacementType) :
+    max_key_size_(max_key_size),
+    max_value_size_(max_value_size),
+    data_blocks_(sizeof(TupleSlot), max_block_capacity, placement_type, (max_key_size + max_value_size) * max_block_capacity) {
 
-    data_blocks_.emplace_back(new DataBlock(0, max_key_size_ + max_value_size_, max_block_capacity_));
-    active_data_block_ = data_blocks_.at(0);
+    ASSERT(max_key_size_ <= std::numeric_limits<uint32_t>::max() && max_value_size_ <= std::numeric_limits<uint32_t>::max(), "exceed maximum tuple size");
   }
   
-  ~GenericDataTable() {
-    for (auto entry : data_blocks_) {
-      delete entry;
-      entry = nullptr;
-    }
-  }
+  ~GenericDataTable() {}
 
+  // threads insert into their own blocks, so inserts only share the block id counter.
   OffsetT insert_tuple(const char *key, const uint64_t key_size, const char *value, const uint64_t value_size) {
-    // key_size must be at least 1 byte smaller than max_key_size_
     ASSERT(key_size <= max_key_size_, "exceed max key size: " << key_size << " " << max_key_size_);
     ASSERT(value_size <= max_value_size_, "exceed max value size: " << value_size << " " << max_value_size_);
 
-    while (true) {
-      DataBlock* tmp_block = active_data_block_;
-
-      RelOffsetT rel_offset = tmp_block->get_next_rel_offset();
+    DataBlock *block = nullptr;
+    OffsetT tuple_offset = data_blocks_.reserve_slot(block);
 
-      if (rel_offset != INVALID_OFFSET) {
-        
-        OffsetT tuple_offset(tmp_block->get_block_id(), rel_offset);
+    // the heap holds enough bytes for every slot, so it is never full before the slots.
+    size_t heap_offset = 0;
+    char *data = block->reserve_heap(key_size + value_size, heap_offset);
 
-        // copy data.
-        char* data = tmp_block->get_tuple(rel_offset);
-        memcpy(data, key, key_size);
-        memcpy(data + max_key_size_, value, value_size);
+    // copy data.
+    memcpy(data, key, key_size);
+    memcpy(data + key_size, value, value_size);
 
-        if (rel_offset == tmp_block->get_max_rel_offset() - 1) {
-          auto new_block = new DataBlock(tmp_block->get_block_id() + 1, max_key_size_ + max_value_size_, max_block_capacity_);
-          data_blocks_.emplace_back(new_block);
+    TupleSlot *slot = (TupleSlot*)(block->get_tuple(tuple_offset.rel_offset()));
+    slot->heap_offset_ = heap_offset;
+    slot->key_size_ = key_size;
+    slot->value_size_ = value_size;
 
-          COMPILER_MEMORY_FENCE;
-
-          active_data_block_ = new_block;
-        }
-
-        return tuple_offset;
-      }
-    }
+    return tuple_offset;
   }
 
-  char* get_tuple_key(const BlockIDT block_id, const RelOffsetT rel_offset) const {
-
-    char *data = data_blocks_.at(block_id)->get_tuple(rel_offset);
-    return data;
+  TupleView get_tuple_key(const BlockIDT block_id, const RelOffsetT rel_offset) const {
+    return get_key(data_blocks_.get_block(block_id), rel_offset);
   }
 
-  char* get_tuple_value(const BlockIDT block_id, const RelOffsetT rel_offset) const {
-
-    char *data = data_blocks_.at(block_id)->get_tuple(rel_offset);
-    return data + max_key_size_;
+  TupleView get_tuple_value(const BlockIDT block_id, const RelOffsetT rel_offset) const {
+    return get_value(data_blocks_.get_block(block_id), rel_offset);
   }
 
-  char* get_tuple_key(const OffsetT offset) const {
-
-    char *data = data_blocks_.at(offset.block_id())->get_tuple(offset.rel_offset());
-    return data;
+  TupleView get_tuple_key(const OffsetT offset) const {
+    return get_key(data_blocks_.get_block(offset.block_id()), offset.rel_offset());
   }
 
-  char* get_tuple_value(const OffsetT offset) const {
+  TupleView get_tuple_value(const OffsetT offset) const {
+    return get_value(data_blocks_.get_block(offset.block_id()), offset.rel_offset());
+  }
 
-    char *data = data_blocks_.at(offset.block_id())->get_tuple(offset.rel_offset());
-    return data + max_key_size_;
+  // size of a key, read from its slot without touching the key bytes.
+  size_t get_tuple_key_size(const OffsetT offset) const {
+    return get_slot(data_blocks_.get_block(offset.block_id()), offset.rel_offset())->key_size_;
   }
 
   inline size_t get_max_key_size() const { return max_key_size_; }
@@ -91,27 +95,43 @@ public:
   inline size_t get_max_value_size() const { return max_value_size_; }
 
 
+  // blocks may be partially filled, so tuples are counted block by block.
   size_t size() const {
-    ASSERT(data_blocks_.size() != 0, "must have at least one data block");
-    if (data_blocks_.size() == 1) {
-      return data_blocks_.at(0)->size();
-    } else {
-      return (data_blocks_.size() - 1) * max_block_capacity_ + data_blocks_.at(data_blocks_.size() - 1)->size();
-    }
+    return data_blocks_.size();
   }
 
   // approximate data table size
   size_t size_approx() const {
-    assert(data_blocks_.size() != 0);
-    return data_blocks_.size() * max_block_capacity_;
+    return data_blocks_.capacity();
+  }
+
+  BlockIDT get_block_count() const {
+    return data_blocks_.get_block_count();
+  }
+
+  size_t get_block_size(const BlockIDT block_id) const {
+    return data_blocks_.get_block_size(block_id);
+  }
+
+private:
+  static const TupleSlot* get_slot(const DataBlock *block, const RelOffsetT rel_offset) {
+    return (const TupleSlot*)(block->get_tuple(rel_offset));
+  }
+
+  static TupleView get_key(const DataBlock *block, const RelOffsetT rel_offset) {
+    const TupleSlot *slot = get_slot(block, rel_offset);
+    return TupleView(block->get_heap_data(slot->heap_offset_), slot->key_size_);
+  }
+
+  static TupleView get_value(const DataBlock *block, const RelOffsetT rel_offset) {
+    const TupleSlot *slot = get_slot(block, rel_offset);
+    return TupleView(block->get_heap_data(slot->heap_offset_ + slot->key_size_), slot->value_size_);
   }
 
 private:
   uint64_t max_key_size_;
   uint64_t max_value_size_;
-  uint64_t max_block_capacity_;
-  std::vector<DataBlock*> data_blocks_;
-  DataBlock* active_data_block_;
+  DataBlockDirectory data_blocks_;
 
 };
 
@@ -119,63 +139,54 @@ class GenericDataTableIterator {
 
 public:
   struct IteratorEntry {
-    IteratorEntry(const BlockIDT block_id, const RelOffsetT rel_offset, char *key, char *value) : 
+    IteratorEntry(const BlockIDT block_id, const RelOffsetT rel_offset, const TupleView &key, const TupleView &value) : 
       offset_(OffsetT::construct_raw_data(block_id, rel_offset)), key_(key), value_(value) {}
 
     Uint64 offset_;
-    char* key_;
-    char* value_;
+    TupleView key_;
+    TupleView value_;
   };
 
 public:
   GenericDataTableIterator(GenericDataTable *table_ptr) : 
     table_ptr_(table_ptr), curr_block_id_(0), curr_rel_offset_(0) {
-    
-    ASSERT(table_ptr_->data_blocks_.size() != 0, "table must contain at least one data block!");
-    ASSERT(!(table_ptr_->data_blocks_.size() == 1 && table_ptr_->data_blocks_.at(0)->size() == 0), "table must contain at least one tuple!");
-
-    max_rel_offset_ = table_ptr_->max_block_capacity_ - 1; 
 
-    last_block_id_ = table_ptr_->data_blocks_.size() - 1;
+    end_block_id_ = table_ptr_->get_block_count();
+    curr_block_size_ = (curr_block_id_ < end_block_id_) ? table_ptr_->get_block_size(curr_block_id_) : 0;
 
-    size_t last_block_size = table_ptr_->data_blocks_.at(last_block_id_)->size();
-    if (last_block_size == 0) {
-      last_rel_offset_ = max_rel_offset_;
-      last_block_id_ = last_block_id_ - 1;
-    } else {
-      last_rel_offset_ = last_block_size - 1;
-    }
+    skip_visited_blocks();
   }
 
   bool has_next() const {
-    if (curr_block_id_ > last_block_id_ || (curr_block_id_ == last_block_id_ && curr_rel_offset_ > last_rel_offset_)) {
-      return false;
-    } else {
-      return true;
-    }
+    return curr_block_id_ < end_block_id_;
   }
 
   IteratorEntry next() {
     BlockIDT ret_block_id = curr_block_id_;
     RelOffsetT ret_rel_offset = curr_rel_offset_;
 
-    if (curr_rel_offset_ != max_rel_offset_) {
-      curr_rel_offset_++;
-    } else {
+    curr_rel_offset_++;
+    skip_visited_blocks();
+
+    return IteratorEntry(ret_block_id, ret_rel_offset, table_ptr_->get_tuple_key(ret_block_id, ret_rel_offset), table_ptr_->get_tuple_value(ret_block_id, ret_rel_offset));
+  }
+
+private:
+  // move past the blocks whose tuples are all visited, as well as empty blocks.
+  void skip_visited_blocks() {
+    while (curr_block_id_ < end_block_id_ && curr_rel_offset_ >= curr_block_size_) {
       curr_block_id_++;
       curr_rel_offset_ = 0;
+      curr_block_size_ = (curr_block_id_ < end_block_id_) ? table_ptr_->get_block_size(curr_block_id_) : 0;
     }
-    return IteratorEntry(ret_block_id, ret_rel_offset, table_ptr_->get_tuple_key(ret_block_id, ret_rel_offset), table_ptr_->get_tuple_value(ret_block_id, ret_rel_offset));
   }
 
-
 private:
   GenericDataTable *table_ptr_;
 
   BlockIDT curr_block_id_;
   RelOffsetT curr_rel_offset_;
+  size_t curr_block_size_;
 
-  BlockIDT last_block_id_;
-  RelOffsetT last_rel_offset_;
-  RelOffsetT max_rel_offset_;
+  BlockIDT end_block_id_;
 };
@@ -165,6 +165,11 @@ void parse_args(int argc, char* argv[], Config &config) {
     }
   }
 
+  if (config.thread_count_ <= 0) {
+    std::cerr << "error: thread count must be positive!" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
   config.print();
 
 }
@@ -222,11 +227,7 @@ void run_workload(const Config &config) {
 
   // create table
   std::unique_ptr<GenericDataTable> data_table(nullptr);
-  // note that the max_key_size passed to GenericDataTable must be at least 1 byte
-  // larger than the real key_size.
-  // this is because some index structures need to access base table to determine
-  // key data. 
-  data_table.reset(new GenericDataTable(config.key_size_ + 1, config.value_size_));
+  data_table.reset(new GenericDataTable(config.key_size_, config.value_size_));
 
   // create index
   std::unique_ptr<BaseGenericIndex> data_index(nullptr);
@@ -282,13 +283,15 @@ void run_workload(const Config &config) {
 
   //=================================
 
-  operation_counts = new uint64_t[config.thread_count_];
+  size_t thread_count = config.thread_count_;
+
+  operation_counts = new uint64_t[thread_count];
   uint64_t profile_round = (uint64_t)(config.time_duration_ / config.profile_duration_);
 
   uint64_t **operation_counts_profiles = new uint64_t*[profile_round];
   for (uint64_t round_id = 0; round_id < profile_round; ++round_id) {
-    operation_counts_profiles[round_id] = new uint64_t[config.thread_count_];
-    memset(operation_counts_profiles[round_id], 0, config.thread_count_ * sizeof(uint64_t));
+    operation_counts_profiles[round_id] = new uint64_t[thread_count];
+    memset(operation_counts_profiles[round_id], 0, thread_count * sizeof(uint64_t));
   }
   std::vector<double> act_size_profiles; // actual allocated size. Unit: MB. include both index and table
   std::vector<double> table_size_profiles; // table data size. Unit: #tuples.
@@ -305,7 +308,7 @@ void run_workload(const Config &config) {
   // PAPIProfiler::init_papi();
   // PAPIProfiler::start_measure_cache_miss_rate();
   
-  for (uint64_t thread_id = 0; thread_id < config.thread_count_; ++thread_id) {
+  for (uint64_t thread_id = 0; thread_id < thread_count; ++thread_id) {
     worker_threads.push_back(std::move(std::thread(run_thread, thread_id, std::ref(config), init_keys, data_table.get(), data_index.get())));
   }
 
@@ -314,7 +317,7 @@ void run_workload(const Config &config) {
   for (uint64_t round_id = 0; round_id < profile_round; ++round_id) {
     std::this_thread::sleep_for(std::chrono::milliseconds(int(config.profile_duration_ * 1000)));
     
-    memcpy(operation_counts_profiles[round_id], operation_counts, sizeof(uint64_t) * config.thread_count_);
+    memcpy(operation_counts_profiles[round_id], operation_counts, sizeof(uint64_t) * thread_count);
 
     double table_size_approx = data_table->size_approx() * (config.key_size_ + 1 + config.value_size_) * 1.0 / 1024 / 1024;
 
@@ -324,7 +327,7 @@ void run_workload(const Config &config) {
     if (round_id == 0) {
       // first round
       uint64_t operation_count = 0;
-      for (size_t thread_id = 0; thread_id < config.thread_count_; ++thread_id) {
+      for (size_t thread_id = 0; thread_id < thread_count; ++thread_id) {
         operation_count += operation_counts_profiles[0][thread_id];
       }
       total_operation_counts.push_back(operation_count);
@@ -332,7 +335,7 @@ void run_workload(const Config &config) {
     } else {
       // remaining rounds
       uint64_t operation_count = 0;
-      for (size_t thread_id = 0; thread_id < config.thread_count_; ++thread_id) {
+      for (size_t thread_id = 0; thread_id < thread_count; ++thread_id) {
         operation_count += operation_counts_profiles[round_id][thread_id] - operation_counts_profiles[round_id - 1][thread_id];
       }
       total_operation_counts.push_back(operation_count);
@@ -367,14 +370,14 @@ void run_workload(const Config &config) {
   // join all the threads
   is_running = false;
 
-  for (uint64_t i = 0; i < config.thread_count_; ++i) {
+  for (uint64_t i = 0; i < thread_count; ++i) {
     worker_threads.at(i).join();
   }
 
   // PAPIProfiler::stop_measure_cache_miss_rate();
   
   uint64_t total_count = 0;
-  for (uint64_t i = 0; i < config.thread_count_; ++i) {
+  for (uint64_t i = 0; i < thread_count; ++i) {
     total_count += operation_counts[i];
   }
 
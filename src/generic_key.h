@@ -2,182 +2,262 @@
 
 #include <cstring>
 #include <cassert>
+#include <type_traits>
 
 #include "utils.h"
-#include "cityhash.h"
+#include "key_hasher.h"
 
 struct GenericComparator;
 
+struct GenericKey;
+
+// non-owning view of key bytes, for lookups that must not copy the key.
+struct GenericKeyView {
+
+  GenericKeyView(const char *data, const size_t data_size) : data_(data), data_size_(data_size) {}
+
+  inline GenericKeyView(const GenericKey &key);
+
+  inline const char* raw() const { return data_; }
+
+  inline size_t size() const { return data_size_; }
+
+private:
+  const char *data_;
+  size_t data_size_;
+};
+
+// keys of up to INLINE_SIZE bytes are stored in the key itself, so that
+// copying them does not allocate. longer keys are stored on the heap.
+// a key may also borrow the bytes of a view, see borrow().
+// a key caches its first PREFIX_SIZE bytes as a big-endian integer, zero padded,
+// so that most comparisons are decided by one integer comparison.
+// to keep the prefix in sync, key bytes are only written through assign() and resize().
 struct GenericKey {
 
 friend GenericComparator;
 
 public:
-  GenericKey() : data_(nullptr), data_size_(0) {}
+  static const size_t INLINE_SIZE = 24;
+  static const size_t PREFIX_SIZE = sizeof(uint64_t);
 
-  GenericKey(const size_t data_size) {
-    if (data_size == 0) {
-      data_ = nullptr;
-      data_size_ = 0;
-    } else {
-      data_ = new char[data_size];
-      memset(data_, 0, data_size);
-      data_size_ = data_size;
-    }
+  GenericKey() : storage_(), prefix_(0), data_size_(0), is_borrowed_(false) {}
+
+  GenericKey(const size_t data_size) : storage_(), prefix_(0), data_size_(0), is_borrowed_(false) {
+    resize(data_size);
   }
 
-  GenericKey(const char* data, const size_t data_size) { 
+  GenericKey(const char* data, const size_t data_size) : storage_(), prefix_(0), data_size_(0), is_borrowed_(false) {
     if (data_size == 0) {
-      data_size_ = 0;
       ASSERT(data == nullptr, "data must be nullptr");
-    } else {
-      data_ = new char[data_size];
-      memcpy(data_, data, data_size);
-      data_size_ = data_size;
     }
+    assign(data, data_size);
   }
 
-  GenericKey(const GenericKey &key) {
-    if (key.data_size_ == 0) {
-      data_ = nullptr;
-      data_size_ = 0;
-    } else {
-      data_ = new char[key.data_size_];
-      memcpy(data_, key.data_, key.data_size_);
-      data_size_ = key.data_size_;
-    }
+  // the copy of a borrowed key owns its bytes.
+  GenericKey(const GenericKey &key) : storage_(), prefix_(0), data_size_(0), is_borrowed_(false) {
+    assign(key.raw(), key.data_size_);
+  }
+
+  GenericKey(GenericKey &&key) noexcept : prefix_(key.prefix_), data_size_(key.data_size_), is_borrowed_(key.is_borrowed_) {
+    memcpy(&storage_, &key.storage_, sizeof(storage_));
+    key.prefix_ = 0;
+    key.data_size_ = 0;
+    key.is_borrowed_ = false;
   }
 
   ~GenericKey() {
-    delete[] data_;
-    data_ = nullptr;
-    data_size_ = 0;
+    release();
   }
 
   GenericKey& operator=(const GenericKey &key) {
-    if (data_ != nullptr) {
-      ASSERT(data_size_ != 0, "data size cannot be 0");
-      delete[] data_;
-      data_size_ = 0;
+    if (this != &key) {
+      assign(key.raw(), key.data_size_);
     }
-    data_ = new char[key.data_size_];
-    memcpy(data_, key.data_, key.data_size_);
-    data_size_ = key.data_size_;
     return *this;
   }
 
-  inline char* raw() const { return data_; }
+  GenericKey& operator=(GenericKey &&key) noexcept {
+    if (this != &key) {
+      release();
+      memcpy(&storage_, &key.storage_, sizeof(storage_));
+      prefix_ = key.prefix_;
+      data_size_ = key.data_size_;
+      is_borrowed_ = key.is_borrowed_;
+      key.prefix_ = 0;
+      key.data_size_ = 0;
+      key.is_borrowed_ = false;
+    }
+    return *this;
+  }
+
+  // a key pointing to the bytes of view, without copying them.
+  // the key must not outlive the bytes, and must not be modified.
+  static GenericKey borrow(const GenericKeyView &view) {
+    GenericKey key;
+    key.storage_.heap_data_ = const_cast<char*>(view.raw());
+    key.prefix_ = load_prefix(view.raw(), view.size());
+    key.data_size_ = view.size();
+    key.is_borrowed_ = true;
+    return key;
+  }
+
+  inline const char* raw() const {
+    return is_inline() ? storage_.inline_data_ : storage_.heap_data_;
+  }
 
   inline size_t size() const { return data_size_; }
 
+  inline uint64_t prefix() const { return prefix_; }
+
+  // copy data_size bytes, reusing the heap bytes of the key if they fit exactly.
+  void assign(const char *data, const size_t data_size) {
+    if (data_size != data_size_ || is_borrowed_) {
+      release();
+      if (data_size > INLINE_SIZE) {
+        storage_.heap_data_ = new char[data_size];
+      }
+      data_size_ = data_size;
+    }
+    if (data_size != 0) {
+      memcpy(get_data(), data, data_size);
+    }
+    prefix_ = load_prefix(data, data_size);
+  }
+
   // transfer ownership
   void reset(char *data, const size_t data_size) {
-    ASSERT(data_ == nullptr && data_size_ == 0, "must be uninitiated");
+    ASSERT(data_size_ == 0, "must be uninitiated");
 
-    data_ = data;
+    if (data_size <= INLINE_SIZE) {
+      memcpy(storage_.inline_data_, data, data_size);
+      delete[] data;
+    } else {
+      storage_.heap_data_ = data;
+    }
     data_size_ = data_size;
-
+    is_borrowed_ = false;
+    prefix_ = load_prefix(raw(), data_size_);
   }
 
+  // resize to data_size zero bytes
   void resize(const size_t data_size) {
-    ASSERT(data_ == nullptr && data_size_ == 0, "must be uninitiated");
-    
-    if (data_size == 0) {
-      data_ = nullptr;
-      data_size_ = 0;
-    } else {
-      data_ = new char[data_size];
-      memset(data_, 0, data_size);
+    if (data_size != data_size_ || is_borrowed_) {
+      release();
+      if (data_size > INLINE_SIZE) {
+        storage_.heap_data_ = new char[data_size];
+      }
       data_size_ = data_size;
     }
+    memset(get_data(), 0, data_size_);
+    prefix_ = 0;
   }
 
-  bool operator==(const GenericKey &rhs) const {
-    if (data_size_ != rhs.data_size_) {
-      return false;
+  // three-way comparison of the key bytes.
+  static int compare(const GenericKey &lhs, const GenericKey &rhs) {
+    if (lhs.prefix_ != rhs.prefix_) {
+      return (lhs.prefix_ < rhs.prefix_) ? -1 : 1;
     }
-    int rt = memcmp(data_, rhs.data_, data_size_);
-    if (rt == 0) {
-      return true;
-    } else {
-      return false;
+    // the bytes both keys hold within the prefix are equal
+    size_t cmp_len = (lhs.data_size_ < rhs.data_size_) ? lhs.data_size_ : rhs.data_size_;
+    size_t skip_len = (cmp_len < PREFIX_SIZE) ? cmp_len : PREFIX_SIZE;
+    int rt = memcmp(lhs.raw() + skip_len, rhs.raw() + skip_len, cmp_len - skip_len);
+    if (rt != 0) {
+      return rt;
+    }
+    if (lhs.data_size_ == rhs.data_size_) {
+      return 0;
     }
+    return (lhs.data_size_ < rhs.data_size_) ? -1 : 1;
   }
 
-  bool operator<(const GenericKey &rhs) const {
-    size_t cmp_len = (data_size_ < rhs.data_size_) ? data_size_ : rhs.data_size_;
-    int rt = memcmp(data_, rhs.data_, cmp_len);
-    if (rt == 0) {
-      if (data_size_ < rhs.data_size_) {
-        return true;
-      } else {
-        return false;
-      }
-    } else if (rt < 0) {
-      return true;
-    } else {
+  static bool equals(const GenericKey &lhs, const GenericKey &rhs) {
+    if (lhs.prefix_ != rhs.prefix_ || lhs.data_size_ != rhs.data_size_) {
       return false;
     }
+    size_t skip_len = (lhs.data_size_ < PREFIX_SIZE) ? lhs.data_size_ : PREFIX_SIZE;
+    return memcmp(lhs.raw() + skip_len, rhs.raw() + skip_len, lhs.data_size_ - skip_len) == 0;
+  }
+
+  bool operator==(const GenericKey &rhs) const {
+    return equals(*this, rhs);
+  }
+
+  bool operator<(const GenericKey &rhs) const {
+    return compare(*this, rhs) < 0;
   }
 
   bool operator>(const GenericKey &rhs) const {
-    size_t cmp_len = (data_size_ < rhs.data_size_) ? data_size_ : rhs.data_size_;
-    int rt = memcmp(data_, rhs.data_, cmp_len);
-    if (rt == 0) {
-      if (data_size_ > rhs.data_size_) {
-        return true;
-      } else {
-        return false;
-      }
-    } else if (rt > 0) {
-      return true;
-    } else {
-      return false;
+    return compare(*this, rhs) > 0;
+  }
+
+private:
+  // the first PREFIX_SIZE bytes, zero padded, as a big-endian integer.
+  // zero padding keeps the order: a key ordered before another by its padding
+  // is a prefix of the other key.
+  static uint64_t load_prefix(const char *data, const size_t data_size) {
+    uint64_t prefix = 0;
+    if (data_size != 0) {
+      memcpy(&prefix, data, (data_size < PREFIX_SIZE) ? data_size : PREFIX_SIZE);
     }
+    return byte_swap<uint64_t>(prefix);
+  }
+
+  inline bool is_inline() const {
+    return !is_borrowed_ && data_size_ <= INLINE_SIZE;
+  }
+
+  inline char* get_data() {
+    return is_inline() ? storage_.inline_data_ : storage_.heap_data_;
+  }
+
+  void release() {
+    if (!is_inline() && !is_borrowed_) {
+      delete[] storage_.heap_data_;
+    }
+    prefix_ = 0;
+    data_size_ = 0;
+    is_borrowed_ = false;
   }
 
 private:
-  char *data_ = nullptr;
-  size_t data_size_ = 0;
+  // zeroed on construction, as moves copy the whole union.
+  union Storage {
+    char *heap_data_;
+    char inline_data_[INLINE_SIZE];
+  } storage_;
+
+  uint64_t prefix_;
+
+  size_t data_size_ : 63;
+  size_t is_borrowed_ : 1;
 };
 
+// containers such as std::vector only move elements that move without throwing,
+// and copy them otherwise.
+static_assert(std::is_nothrow_move_constructible<GenericKey>::value, "GenericKey must be nothrow move constructible");
+static_assert(std::is_nothrow_move_assignable<GenericKey>::value, "GenericKey must be nothrow move assignable");
+
+inline GenericKeyView::GenericKeyView(const GenericKey &key) : data_(key.raw()), data_size_(key.size()) {}
+
 // "less than" relation
 struct GenericKeyComparator {
   inline bool operator()(const GenericKey &lhs, const GenericKey &rhs) const {
-    size_t cmp_len = (lhs.size() < rhs.size()) ? lhs.size() : rhs.size();
-    int rt = memcmp(lhs.raw(), rhs.raw(), cmp_len);
-    if (rt == 0) {
-      if (lhs.size() < rhs.size()) {
-        return true;
-      } else {
-        return false;
-      }
-    } else if (rt < 0) {
-      return true;
-    } else {
-      return false;
-    }
-
+    return GenericKey::compare(lhs, rhs) < 0;
   }
 };
 
 struct GenericKeyEqualityChecker {
   inline bool operator()(const GenericKey &lhs, const GenericKey &rhs) const {
-    if (lhs.size() != rhs.size()) {
-      return false;
-    }
-    int rt = memcmp(lhs.raw(), rhs.raw(), lhs.size());
-    if (rt == 0) {
-      return true;
-    } else {
-      return false;
-    }
+    return GenericKey::equals(lhs, rhs);
   }
 };
 
+// hasher policy over the key bytes, see key_hasher.h
+template<typename HasherT = DefaultHasher>
 struct GenericKeyHasher {
   inline std::size_t operator()(const GenericKey &key) const {
-    return CityHash64(key.raw(), key.size());
+    return hash_key<HasherT>(key.raw(), key.size());
   }
 };
 
@@ -0,0 +1,342 @@
+#include <cassert>
+#include <algorithm>
+#include <string>
+#include <cstdint>
+#include <vector>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <functional>
+#include <cstring>
+#include <unistd.h>
+#include <getopt.h>
+
+#include "time_measurer.h"
+#include "fast_random.h"
+#include "generic_key.h"
+#include "key_hasher.h"
+#include "dynamic_index/multithread/libcuckoo/cuckoohash_map.hh"
+
+
+void usage(FILE *out) {
+  fprintf(out,
+          "Command line options : hash_benchmark <options> \n"
+          "   -h --help              :  print help message \n"
+          "   -k --key_size          :  key size (default: 8 bytes) \n"
+          "   -m --key_count         :  key count (default: 1ull<<20) \n"
+          "   -w --key_type          :  key type: \n"
+          "                              -- (0) random bytes (default) \n"
+          "                              -- (1) sequence numbers \n"
+          "                              -- (2) sequence numbers with a stride of 1<<16 \n"
+          "   -r --round_count       :  rounds of hashing all keys (default: 10) \n"
+  );
+}
+
+static struct option opts[] = {
+    { "key_size",          optional_argument, NULL, 'k' },
+    { "key_count",         optional_argument, NULL, 'm' },
+    { "key_type",          optional_argument, NULL, 'w' },
+    { "round_count",       optional_argument, NULL, 'r' },
+    { NULL, 0, NULL, 0 }
+};
+
+enum class KeyType {
+  RandomKeyType = 0,
+  SequenceKeyType,
+  StrideKeyType,
+};
+
+struct Config {
+  int key_size_ = 8; // unit: bytes
+  uint64_t key_count_ = 1ull << 20;
+  KeyType key_type_ = KeyType::RandomKeyType;
+  int round_count_ = 10;
+
+  void print() {
+    std::cout << "key size: " << key_size_ << std::endl;
+    std::cout << "key count: " << key_count_ << std::endl;
+    std::cout << "key type: " << (int)key_type_ << std::endl;
+    std::cout << "round count: " << round_count_ << std::endl;
+#if defined(__SSE4_2__)
+    std::cout << "crc32c: sse4.2" << std::endl;
+#else
+    std::cout << "crc32c: not available, falls back to wyhash" << std::endl;
+#endif
+    std::cout << ">>>>>>>>>>>>>>>>>>>>>>" << std::endl;
+  }
+};
+
+void parse_args(int argc, char* argv[], Config &config) {
+
+  while (1) {
+    int idx = 0;
+    int c = getopt_long(argc, argv, "hk:m:w:r:", opts, &idx);
+
+    if (c == -1) break;
+
+    switch (c) {
+      case 'k': {
+        config.key_size_ = atoi(optarg);
+        break;
+      }
+      case 'm': {
+        config.key_count_ = (uint64_t)strtoull(optarg, nullptr, 10); // uint64_t
+        break;
+      }
+      case 'w': {
+        config.key_type_ = (KeyType)atoi(optarg);
+        break;
+      }
+      case 'r': {
+        config.round_count_ = atoi(optarg);
+        break;
+      }
+      case 'h': {
+        usage(stderr);
+        exit(EXIT_FAILURE);
+        break;
+      }
+      default: {
+        fprintf(stderr, "Unknown option: -%c-\n", c);
+        usage(stderr);
+        exit(EXIT_FAILURE);
+        break;
+      }
+    }
+  }
+
+  if (config.key_size_ <= 0) {
+    fprintf(stderr, "key size must be positive: %d\n", config.key_size_);
+    exit(EXIT_FAILURE);
+  }
+
+  config.print();
+}
+
+// std::hash of the numeric LibcuckooIndex before hasher policies, for 8-byte keys only
+struct StdHasher {
+
+  static inline uint64_t hash_bytes(const char *data, const size_t size) {
+    ASSERT(false, "std::hash only applies to 8-byte keys");
+    return 0;
+  }
+
+  static inline uint64_t hash8(const uint64_t word) {
+    return std::hash<uint64_t>()(word);
+  }
+
+  static inline uint64_t hash16(const uint64_t lo_word, const uint64_t hi_word) {
+    ASSERT(false, "std::hash only applies to 8-byte keys");
+    return 0;
+  }
+};
+
+// a model of the libcuckoo table: buckets of 4 slots, and the same bucket and
+// partial key functions. keys are inserted into their first bucket if it has a free
+// slot, then into their second bucket, then by a random walk of evictions.
+// it only keeps hash values, so that probe lengths can be read off the buckets.
+class CuckooModel {
+
+  static const size_t SLOT_COUNT = 4;
+  static const size_t MAX_KICK_COUNT = 500;
+
+public:
+  CuckooModel(const size_t bucket_count) :
+    bucket_mask_(bucket_count - 1),
+    hashes_(bucket_count * SLOT_COUNT, 0),
+    occupied_(bucket_count * SLOT_COUNT, false),
+    rand_(0),
+    size_(0),
+    kick_count_(0) {
+
+    ASSERT(bucket_count >= 1 && (bucket_count & (bucket_count - 1)) == 0, "bucket count must be a power of two: " << bucket_count);
+  }
+
+  // return false if no free slot is found within MAX_KICK_COUNT evictions
+  bool insert(uint64_t hash) {
+    size_t bucket_id = hash & bucket_mask_;
+    if (insert_into(bucket_id, hash)) {
+      return true;
+    }
+    bucket_id = get_alt_bucket(bucket_id, hash);
+    if (insert_into(bucket_id, hash)) {
+      return true;
+    }
+    for (size_t i = 0; i < MAX_KICK_COUNT; ++i) {
+      size_t pos = bucket_id * SLOT_COUNT + rand_.next<uint8_t>() % SLOT_COUNT;
+      std::swap(hash, hashes_[pos]);
+      ++kick_count_;
+
+      bucket_id = get_alt_bucket(bucket_id, hash);
+      if (insert_into(bucket_id, hash)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  size_t size() const { return size_; }
+
+  double load_factor() const { return size_ * 1.0 / hashes_.size(); }
+
+  double kicks_per_insert() const { return kick_count_ * 1.0 / size_; }
+
+  // a lookup probes the first bucket, and the second bucket if the key is not there
+  double probes_per_find() const {
+    size_t probe_count = 0;
+    for (size_t pos = 0; pos < hashes_.size(); ++pos) {
+      if (occupied_[pos]) {
+        probe_count += ((hashes_[pos] & bucket_mask_) == pos / SLOT_COUNT) ? 1 : 2;
+      }
+    }
+    return probe_count * 1.0 / size_;
+  }
+
+private:
+  bool insert_into(const size_t bucket_id, const uint64_t hash) {
+    for (size_t pos = bucket_id * SLOT_COUNT; pos < (bucket_id + 1) * SLOT_COUNT; ++pos) {
+      if (!occupied_[pos]) {
+        hashes_[pos] = hash;
+        occupied_[pos] = true;
+        ++size_;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // partial_key() and alt_index() of libcuckoo
+  size_t get_alt_bucket(const size_t bucket_id, const uint64_t hash) const {
+    uint32_t hash_32bit = (uint32_t)hash ^ (uint32_t)(hash >> 32);
+    uint16_t hash_16bit = (uint16_t)hash_32bit ^ (uint16_t)(hash_32bit >> 16);
+    uint8_t partial = (uint8_t)hash_16bit ^ (uint8_t)(hash_16bit >> 8);
+    return (bucket_id ^ ((partial + 1ull) * 0xc6a4a7935bd1e995ull)) & bucket_mask_;
+  }
+
+private:
+  size_t bucket_mask_;
+  std::vector<uint64_t> hashes_;
+  std::vector<bool> occupied_;
+
+  FastRandom rand_;
+  size_t size_;
+  size_t kick_count_;
+};
+
+// keeps hash values alive, so that hashing is not optimized away
+uint64_t hash_sink = 0;
+
+template<typename HasherT>
+void run_hasher(const std::string &hasher_name, const Config &config, const std::vector<GenericKey> &keys) {
+
+  GenericKeyHasher<HasherT> hasher;
+  TimeMeasurer timer;
+
+  // hash throughput
+  uint64_t checksum = 0;
+  timer.tic();
+  for (int round_id = 0; round_id < config.round_count_; ++round_id) {
+    for (auto &key : keys) {
+      checksum += hasher(key);
+    }
+  }
+  timer.toc();
+  double hash_throughput = keys.size() * config.round_count_ * 1.0 / timer.time_us();
+
+  // libcuckoo throughput
+  cuckoohash_map<GenericKey, Uint64, GenericKeyHasher<HasherT>> container;
+  container.reserve(keys.size());
+
+  // libcuckoo gives up on a table that is poorly filled but has no cuckoo path,
+  // as happens when many keys share both buckets. throughputs are 0 then.
+  double insert_throughput = 0;
+  double find_throughput = 0;
+  try {
+    timer.tic();
+    for (size_t i = 0; i < keys.size(); ++i) {
+      container.insert(keys[i], i);
+    }
+    timer.toc();
+    insert_throughput = keys.size() * 1.0 / timer.time_us();
+
+    Uint64 value = 0;
+    timer.tic();
+    for (auto &key : keys) {
+      checksum += container.find(key, value);
+    }
+    timer.toc();
+    find_throughput = keys.size() * 1.0 / timer.time_us();
+  } catch (libcuckoo_load_factor_too_low &e) {
+    std::cout << hasher_name << ": " << e.what() << std::endl;
+  }
+
+  // probe lengths, on a model table with one slot per key
+  size_t bucket_count = 1;
+  while (bucket_count * 4 < keys.size()) {
+    bucket_count <<= 1;
+  }
+  CuckooModel model(bucket_count);
+  for (auto &key : keys) {
+    if (!model.insert(hasher(key))) {
+      break;
+    }
+  }
+
+  std::cout << std::fixed << std::setprecision(2) << std::left
+            << std::setw(8) << hasher_name << std::right
+            << std::setw(12) << hash_throughput
+            << std::setw(12) << insert_throughput
+            << std::setw(12) << find_throughput
+            << std::setw(12) << model.load_factor()
+            << std::setw(12) << model.probes_per_find()
+            << std::setw(12) << model.kicks_per_insert()
+            << std::endl;
+
+  hash_sink += checksum;
+}
+
+void run_workload(const Config &config) {
+
+  std::vector<GenericKey> keys;
+  keys.reserve(config.key_count_);
+
+  FastRandom rand_gen(0);
+  std::string key_bytes;
+
+  for (uint64_t i = 0; i < config.key_count_; ++i) {
+    if (config.key_type_ == KeyType::RandomKeyType) {
+      rand_gen.next_string(config.key_size_, key_bytes);
+    } else {
+      uint64_t number = (config.key_type_ == KeyType::StrideKeyType) ? (i << 16) : i;
+      key_bytes.assign(config.key_size_, 0);
+      memcpy(&key_bytes[0], &number, std::min(sizeof(number), key_bytes.size()));
+    }
+    keys.push_back(GenericKey(key_bytes.data(), key_bytes.size()));
+  }
+
+  std::cout << std::left << std::setw(8) << "hasher" << std::right
+            << std::setw(12) << "hash (M/s)"
+            << std::setw(12) << "ins. (M/s)"
+            << std::setw(12) << "find (M/s)"
+            << std::setw(12) << "max load"
+            << std::setw(12) << "probes"
+            << std::setw(12) << "kicks"
+            << std::endl;
+
+  if (config.key_size_ == sizeof(uint64_t)) {
+    run_hasher<StdHasher>("std", config, keys);
+  }
+  run_hasher<CityHasher>("city", config, keys);
+  run_hasher<Crc32cHasher>("crc32c", config, keys);
+  run_hasher<WyHasher>("wyhash", config, keys);
+}
+
+int main(int argc, char* argv[]) {
+
+  Config config;
+  parse_args(argc, argv, config);
+
+  run_workload(config);
+
+  return 0;
+}
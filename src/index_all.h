@@ -6,6 +6,10 @@
 #include "static_index/binary_index.h"
 #include "static_index/kary_index.h"
 #include "static_index/fast_index.h"
+#include "static_index/eytzinger_index.h"
+#include "static_index/learned_index.h"
+#include "static_index/compressed_index.h"
+#include "static_index/delta_index.h"
 
 #include "dynamic_index/singlethread/stx_btree_index.h"
 #include "dynamic_index/singlethread/art_tree_index.h"
@@ -41,6 +45,9 @@ enum class IndexType {
   S_Binary, 
   S_KAry, 
   S_Fast,
+  S_Eytzinger,
+  S_Learned,
+  S_Compressed,
 
 };
 
@@ -54,6 +61,12 @@ static std::string get_index_name(const IndexType index_type) {
     return "static - k-ary index";
   } else if (index_type == IndexType::S_Fast) {
     return "static - fast index";
+  } else if (index_type == IndexType::S_Eytzinger) {
+    return "static - eytzinger index";
+  } else if (index_type == IndexType::S_Learned) {
+    return "static - learned index";
+  } else if (index_type == IndexType::S_Compressed) {
+    return "static - compressed index";
   } else if (index_type == IndexType::D_ST_StxBtree) {
     return "dynamic - singlethread - stx-btree index";
   } else if (index_type == IndexType::D_ST_ArtTree) {
@@ -74,6 +87,14 @@ static std::string get_index_name(const IndexType index_type) {
 
 static const int INVALID_INDEX_PARAM = -1;
 
+// the 2nd parameter of the interpolation index selects its segmentation
+static SegmentationType get_segmentation_type(const int index_param_2) {
+  if (index_param_2 == INVALID_INDEX_PARAM) {
+    return SegmentationType::EquiWidthSegmentationType;
+  }
+  return (SegmentationType)index_param_2;
+}
+
 // make sure that required parameters are set
 static void validate_index_params(const IndexType index_type, const int index_param_1, const int index_param_2) {
   if (index_type == IndexType::S_Interpolation) {
@@ -85,8 +106,18 @@ static void validate_index_params(const IndexType index_type, const int index_pa
       return;
     }
 
+    if (index_param_2 != INVALID_INDEX_PARAM && 
+        index_param_2 != (int)SegmentationType::EquiWidthSegmentationType && 
+        index_param_2 != (int)SegmentationType::EquiDepthSegmentationType) {
+      std::cerr << "expected index type: static - interpolation index" << std::endl;
+      std::cerr << "error: unknown segmentation type!" << std::endl;
+      exit(EXIT_FAILURE);
+      return;
+    }
+
     std::cout << "index type: static - interpolation index" << std::endl;
     std::cout << "number of segments: " << index_param_1 << std::endl;
+    std::cout << "segmentation: " << get_segmentation_name(get_segmentation_type(index_param_2)) << std::endl;
 
   } else if (index_type == IndexType::S_Binary) {
     
@@ -139,6 +170,44 @@ static void validate_index_params(const IndexType index_type, const int index_pa
     std::cout << "index type: static - fast index" << std::endl;
     std::cout << "number of layers: " << index_param_1 << std::endl;
 
+  } else if (index_type == IndexType::S_Learned) {
+    
+    if (index_param_1 == INVALID_INDEX_PARAM) {
+      std::cerr << "expected index type: static - learned index" << std::endl;
+      std::cerr << "error: number of models is unset!" << std::endl;
+      exit(EXIT_FAILURE);
+      return;
+    }
+
+    if (index_param_1 < 1) {
+      std::cerr << "expected index type: static - learned index" << std::endl;
+      std::cerr << "error: number of models must be larger than or equal to 1!" << std::endl;
+      exit(EXIT_FAILURE);
+      return;
+    }
+    
+    std::cout << "index type: static - learned index" << std::endl;
+    std::cout << "number of models: " << index_param_1 << std::endl;
+
+  } else if (index_type == IndexType::S_Compressed) {
+
+    if (index_param_1 == INVALID_INDEX_PARAM) {
+      std::cerr << "expected index type: static - compressed index" << std::endl;
+      std::cerr << "error: number of keys per block is unset!" << std::endl;
+      exit(EXIT_FAILURE);
+      return;
+    }
+
+    if (index_param_1 < 1 || (index_param_1 & (index_param_1 - 1)) != 0) {
+      std::cerr << "expected index type: static - compressed index" << std::endl;
+      std::cerr << "error: number of keys per block must be a power of two!" << std::endl;
+      exit(EXIT_FAILURE);
+      return;
+    }
+
+    std::cout << "index type: static - compressed index" << std::endl;
+    std::cout << "number of keys per block: " << index_param_1 << std::endl;
+
   } else {
     
     std::cout << "index type: " << get_index_name(index_type) << std::endl;
@@ -148,23 +217,36 @@ static void validate_index_params(const IndexType index_type, const int index_pa
 }
 
 template<typename KeyT, typename ValueT>
-static BaseIndex<KeyT, ValueT>* create_numeric_index(const IndexType index_type, DataTable<KeyT, uint64_t> *table_ptr, const int index_param_1 = INVALID_INDEX_PARAM, const int index_param_2 = INVALID_INDEX_PARAM) {
+static BaseIndex<KeyT, ValueT>* create_numeric_index(const IndexType index_type, DataTable<KeyT, uint64_t> *table_ptr, const int index_param_1 = INVALID_INDEX_PARAM, const int index_param_2 = INVALID_INDEX_PARAM, const StaticLayoutType layout_type = StaticLayoutType::AoSLayoutType) {
 
   if (index_type == IndexType::S_Interpolation) {
 
-    return new static_index::InterpolationIndex<KeyT, ValueT>(table_ptr, index_param_1);
+    return new static_index::InterpolationIndex<KeyT, ValueT>(table_ptr, index_param_1, layout_type, get_segmentation_type(index_param_2));
   
   } else if (index_type == IndexType::S_Binary) {
 
-    return new static_index::BinaryIndex<KeyT, ValueT>(table_ptr, index_param_1);
+    return new static_index::BinaryIndex<KeyT, ValueT>(table_ptr, index_param_1, layout_type);
 
   } else if (index_type == IndexType::S_KAry) {
 
-    return new static_index::KAryIndex<KeyT, ValueT>(table_ptr, index_param_1, index_param_2);
+    return new static_index::KAryIndex<KeyT, ValueT>(table_ptr, index_param_1, index_param_2, layout_type);
 
   } else if (index_type == IndexType::S_Fast) {
 
-    return new static_index::FastIndex<KeyT, ValueT>(table_ptr, index_param_1);
+    return new static_index::FastIndex<KeyT, ValueT>(table_ptr, index_param_1, layout_type);
+
+  } else if (index_type == IndexType::S_Eytzinger) {
+
+    return new static_index::EytzingerIndex<KeyT, ValueT>(table_ptr, layout_type);
+
+  } else if (index_type == IndexType::S_Learned) {
+
+    return new static_index::LearnedIndex<KeyT, ValueT>(table_ptr, index_param_1, layout_type);
+
+  } else if (index_type == IndexType::S_Compressed) {
+
+    // keys are always compressed in place of a key array
+    return new static_index::CompressedIndex<KeyT, ValueT>(table_ptr, index_param_1);
 
   } else if (index_type == IndexType::D_ST_StxBtree) {
 
@@ -197,6 +279,23 @@ static BaseIndex<KeyT, ValueT>* create_numeric_index(const IndexType index_type,
   }
 }
 
+static bool is_static_index(const IndexType index_type) {
+  return index_type >= IndexType::S_Interpolation;
+}
+
+// wrap a static index so that it absorbs updates into a delta,
+// which is merged into a new static index every merge_threshold updates.
+template<typename KeyT, typename ValueT>
+static BaseIndex<KeyT, ValueT>* create_delta_index(const IndexType index_type, DataTable<KeyT, uint64_t> *table_ptr, const size_t merge_threshold, const int index_param_1 = INVALID_INDEX_PARAM, const int index_param_2 = INVALID_INDEX_PARAM, const StaticLayoutType layout_type = StaticLayoutType::AoSLayoutType) {
+
+  ASSERT(is_static_index(index_type), "only static indexes can be wrapped by a delta index");
+
+  auto factory = [=]() {
+    return dynamic_cast<BaseStaticIndex<KeyT, ValueT>*>(create_numeric_index<KeyT, ValueT>(index_type, table_ptr, index_param_1, index_param_2, layout_type));
+  };
+  return new static_index::DeltaIndex<KeyT, ValueT>(table_ptr, factory, merge_threshold);
+}
+
 
 static BaseGenericIndex* create_generic_index(const IndexType index_type, GenericDataTable *table_ptr) {
 
@@ -210,7 +309,7 @@ static BaseGenericIndex* create_generic_index(const IndexType index_type, Generi
 
   } else if (index_type == IndexType::D_MT_Libcuckoo) {
 
-    return new dynamic_index::multithread::LibcuckooGenericIndex(table_ptr);
+    return new dynamic_index::multithread::LibcuckooGenericIndex<>(table_ptr);
 
   } else if (index_type == IndexType::D_MT_ArtTree) {
 
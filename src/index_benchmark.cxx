@@ -1,6 +1,7 @@
 #include <cassert>
 #include <cstdint>
 #include <vector>
+#include <algorithm>
 #include <thread>
 #include <cstdio>
 #include <chrono>
@@ -35,17 +36,34 @@ void usage(FILE *out) {
           "                              -- (21) static  - binary index \n"
           "                              -- (22) static  - kary index \n"
           "                              -- (23) static  - fast index \n"
+          "                              -- (24) static  - eytzinger index \n"
+          "                              -- (25) static  - learned index \n"
+          "                              -- (26) static  - compressed index \n"
           "   -k --key_size          :  index key size (default: 8 bytes) \n"
           "   -S --index_param_1     :  1st index parameter \n"
           "   -T --index_param_2     :  2nd index parameter \n"
+          "   -l --storage_layout    :  storage layout of static indexes: \n"
+          "                              -- (0) array of structures (default) \n"
+          "                              -- (1) structure of arrays \n"
+          "   -g --huge_pages        :  back arrays of static indexes with huge pages \n"
+          "   -u --merge_threshold   :  absorb updates of static indexes into a delta merged every N updates \n"
+          "   -b --block_capacity    :  number of tuples per data table block, a power of two (default: 65536) \n"
+          "   -n --numa_local        :  place data table blocks on the NUMA node of the inserting thread \n"
+          "   -L --table_layout      :  layout of data table blocks: \n"
+          "                              -- (0) row (default) \n"
+          "                              -- (1) column \n"
           // configuration
           "   -t --time_duration     :  time duration (default: 10) \n"
           "   -y --read_type         :  read type: \n"
           "                              -- (0) index lookup (default) \n"
           "                              -- (1) index scan \n"
           "                              -- (2) index reverse scan \n"
+          "                              -- (3) index range lookup \n"
+          "                              -- (4) index batch lookup \n"
+          "   -e --selectivity       :  fraction of keys covered by a range lookup (default: 0.001) \n"
+          "   -w --range_sweep       :  sweep range lookup selectivity from 0.00001 to 0.1 \n"
           "   -r --read_ratio        :  read ratio (default: 1.0) \n"
-          "   -s --thread_count      :  thread count (default: 1) \n"
+          "   -s --thread_count      :  thread count, also used to reorganize static indexes (default: 1) \n"
           "   -m --key_count         :  key count (default: 1ull<<20) \n"
           // numeric data distribution
           "   -d --distribution      :  numerical data distribution: \n"
@@ -69,9 +87,17 @@ static struct option opts[] = {
     { "key_size",          optional_argument, NULL, 'k' },
     { "index_param_1",     optional_argument, NULL, 'S' },
     { "index_param_2",     optional_argument, NULL, 'T' },
+    { "storage_layout",    optional_argument, NULL, 'l' },
+    { "huge_pages",        optional_argument, NULL, 'g' },
+    { "merge_threshold",   optional_argument, NULL, 'u' },
+    { "block_capacity",    optional_argument, NULL, 'b' },
+    { "numa_local",        optional_argument, NULL, 'n' },
+    { "table_layout",      optional_argument, NULL, 'L' },
     // configuration
     { "time_duration",     optional_argument, NULL, 't' },
     { "read_type",         optional_argument, NULL, 'y' },
+    { "selectivity",       optional_argument, NULL, 'e' },
+    { "range_sweep",       optional_argument, NULL, 'w' },
     { "read_ratio",        optional_argument, NULL, 'r' },
     { "thread_count",      optional_argument, NULL, 's' },
     // data distribution
@@ -88,18 +114,31 @@ enum class ReadType {
   IndexLookupType = 0,
   IndexScanType,
   IndexScanReverseType,
+  IndexRangeLookupType,
+  IndexBatchLookupType,
 };
 
+// number of keys looked up by a batch lookup
+static const size_t LOOKUP_BATCH_SIZE = 64;
+
 struct Config {
   // index structure
   IndexType index_type_ = IndexType::D_ST_StxBtree;
   int key_size_ = 8; // unit: bytes
   int index_param_1_ = INVALID_INDEX_PARAM;
   int index_param_2_ = INVALID_INDEX_PARAM;
+  StaticLayoutType layout_type_ = StaticLayoutType::AoSLayoutType;
+  StaticAllocationType allocation_type_ = StaticAllocationType::DefaultAllocationType;
+  int merge_threshold_ = 0; // 0: static indexes ignore updates
+  uint64_t block_capacity_ = MaxBlockCapacity;
+  BlockPlacementType block_placement_type_ = BlockPlacementType::FirstTouchPlacementType;
+  TableLayoutType table_layout_type_ = TableLayoutType::RowLayoutType;
   // configuration
   const double profile_duration_ = 0.5; // fixed
   int time_duration_ = 10;
   ReadType index_read_type_ = ReadType::IndexLookupType;
+  double selectivity_ = 0.001;
+  bool range_sweep_ = false;
   double read_ratio_ = 1.0;
   int thread_count_ = 1;
   // data distribution
@@ -114,8 +153,19 @@ struct Config {
     std::cout << "=====     INDEX STRUCTURE    =====" << std::endl;
     std::cout << "key size: " << key_size_ << std::endl;
     std::cout << "index param " << index_param_1_ << ", " << index_param_2_ << std::endl;
+    std::cout << "storage layout: " << get_static_layout_name(layout_type_) << std::endl;
+    std::cout << "static allocation: " << get_static_allocation_name(allocation_type_) << std::endl;
+    if (merge_threshold_ != 0) {
+      std::cout << "merge threshold: " << merge_threshold_ << std::endl;
+    }
+    std::cout << "block capacity: " << block_capacity_ << std::endl;
+    std::cout << "block placement: " << get_block_placement_name(block_placement_type_) << std::endl;
+    std::cout << "table layout: " << get_table_layout_name(table_layout_type_) << std::endl;
     std::cout << "===== WORKLOAD CONFIGURATION =====" << std::endl;
     std::cout << "read ratio: " << read_ratio_ << std::endl;
+    if (index_read_type_ == ReadType::IndexRangeLookupType) {
+      std::cout << "selectivity: " << selectivity_ << std::endl;
+    }
     std::cout << "thread count: " << thread_count_ << std::endl;
     std::cout << "=====    DATA DISTRIBUTION   =====" << std::endl;
     std::cout << "key count: " << key_count_ << std::endl;
@@ -131,7 +181,7 @@ void parse_args(int argc, char* argv[], Config &config) {
   
   while (1) {
     int idx = 0;
-    int c = getopt_long(argc, argv, "hcvi:k:S:T:t:y:r:s:m:d:P:Q:", opts, &idx);
+    int c = getopt_long(argc, argv, "hcvwgni:k:S:T:l:u:b:L:t:y:e:r:s:m:d:P:Q:", opts, &idx);
 
     if (c == -1) break;
 
@@ -152,6 +202,30 @@ void parse_args(int argc, char* argv[], Config &config) {
         config.index_param_2_ = atoi(optarg);
         break;
       }
+      case 'l': {
+        config.layout_type_ = (StaticLayoutType)atoi(optarg);
+        break;
+      }
+      case 'g': {
+        config.allocation_type_ = StaticAllocationType::HugePageAllocationType;
+        break;
+      }
+      case 'u': {
+        config.merge_threshold_ = atoi(optarg);
+        break;
+      }
+      case 'b': {
+        config.block_capacity_ = strtoull(optarg, NULL, 10);
+        break;
+      }
+      case 'n': {
+        config.block_placement_type_ = BlockPlacementType::LocalNodePlacementType;
+        break;
+      }
+      case 'L': {
+        config.table_layout_type_ = (TableLayoutType)atoi(optarg);
+        break;
+      }
       case 't': {
         config.time_duration_ = atoi(optarg);
         break;
@@ -160,6 +234,14 @@ void parse_args(int argc, char* argv[], Config &config) {
         config.index_read_type_ = (ReadType)atoi(optarg);
         break;
       }
+      case 'e': {
+        config.selectivity_ = (double)atof(optarg);
+        break;
+      }
+      case 'w': {
+        config.range_sweep_ = true;
+        break;
+      }
       case 'r': {
         config.read_ratio_ = (double)atof(optarg);
         break;
@@ -208,6 +290,41 @@ void parse_args(int argc, char* argv[], Config &config) {
 
   validate_index_params(config.index_type_, config.index_param_1_, config.index_param_2_);
 
+  if (config.thread_count_ <= 0) {
+    std::cerr << "error: thread count must be positive!" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  if (config.layout_type_ != StaticLayoutType::AoSLayoutType && config.layout_type_ != StaticLayoutType::SoALayoutType) {
+    std::cerr << "error: invalid storage layout!" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  if (config.merge_threshold_ < 0) {
+    std::cerr << "error: merge threshold must be non-negative!" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  if (config.merge_threshold_ != 0 && !is_static_index(config.index_type_)) {
+    std::cerr << "error: merge threshold only applies to static indexes!" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  if (config.block_capacity_ == 0 || (config.block_capacity_ & (config.block_capacity_ - 1)) != 0 || config.block_capacity_ > (1ull << BLOCKOFFSET_BITS)) {
+    std::cerr << "error: block capacity must be a power of two no larger than " << (1ull << BLOCKOFFSET_BITS) << "!" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  if (config.table_layout_type_ != TableLayoutType::RowLayoutType && config.table_layout_type_ != TableLayoutType::ColumnLayoutType) {
+    std::cerr << "error: invalid table layout!" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  if (config.selectivity_ <= 0 || config.selectivity_ > 1) {
+    std::cerr << "error: selectivity must be in (0, 1]!" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
   validate_key_generator_params(config.distribution_type_, config.key_bound_, config.key_stddev_);
   
   config.print();
@@ -217,6 +334,23 @@ void parse_args(int argc, char* argv[], Config &config) {
 bool is_running = false;
 uint64_t *operation_counts = nullptr;
 
+// number of keys covered by a range lookup with the given selectivity
+static uint64_t get_range_width(const uint64_t key_count, const double selectivity) {
+  uint64_t range_width = (uint64_t)(key_count * selectivity);
+  return range_width == 0 ? 1 : range_width;
+}
+
+// run range lookups whose bounds are taken from the sorted query keys,
+// so that each lookup covers range_width keys regardless of the key distribution.
+template<typename KeyT, typename ValueT>
+static void range_lookup(const KeyT *sorted_keys, const uint64_t key_count, const uint64_t range_width, FastRandom &rand_gen, BaseIndex<KeyT, ValueT> *data_index, std::vector<Uint64> &offsets) {
+
+  uint64_t lhs_pos = rand_gen.next<uint64_t>() % key_count;
+  uint64_t rhs_pos = std::min(lhs_pos + range_width - 1, key_count - 1);
+
+  data_index->find_range(sorted_keys[lhs_pos], sorted_keys[rhs_pos], offsets);
+}
+
 template<typename KeyT, typename ValueT>
 void run_thread(const size_t &thread_id, const Config &config, const KeyT *query_keys, DataTable<KeyT, ValueT> *data_table, BaseIndex<KeyT, ValueT> *data_index) {
 
@@ -231,6 +365,8 @@ void run_thread(const size_t &thread_id, const Config &config, const KeyT *query
 
   FastRandom rand_gen(thread_id);
 
+  uint64_t range_width = get_range_width(config.key_count_, config.selectivity_);
+
   while (true) {
     if (is_running == false) {
       break;
@@ -238,7 +374,45 @@ void run_thread(const size_t &thread_id, const Config &config, const KeyT *query
 
     double next_rand = rand_gen.next_uniform();
 
-    if (next_rand < config.read_ratio_) {
+    if (next_rand < config.read_ratio_ && config.index_read_type_ == ReadType::IndexRangeLookupType) {
+
+      std::vector<Uint64> offsets;
+
+      // retrieve tuple locations in [lhs_key, rhs_key]
+      range_lookup(query_keys, config.key_count_, range_width, rand_gen, data_index, offsets);
+
+    } else if (next_rand < config.read_ratio_ && config.index_read_type_ == ReadType::IndexBatchLookupType) {
+
+      KeyT keys[LOOKUP_BATCH_SIZE];
+      for (size_t i = 0; i < LOOKUP_BATCH_SIZE; ++i) {
+        keys[i] = query_keys[rand_gen.next<uint64_t>() % config.key_count_];
+      }
+
+      std::vector<Uint64> offsets[LOOKUP_BATCH_SIZE];
+
+      // retrieve tuple locations of all keys at once
+      data_index->find_batch(keys, LOOKUP_BATCH_SIZE, offsets);
+
+      // count each key as one operation
+      operation_count += LOOKUP_BATCH_SIZE - 1;
+
+    } else if (next_rand < config.read_ratio_ && config.index_read_type_ == ReadType::IndexScanType) {
+      KeyT key = query_keys[rand_gen.next<uint64_t>() % config.key_count_];
+
+      std::vector<Uint64> offsets;
+
+      // retrieve tuple locations in key order
+      data_index->scan(key, offsets);
+
+    } else if (next_rand < config.read_ratio_ && config.index_read_type_ == ReadType::IndexScanReverseType) {
+      KeyT key = query_keys[rand_gen.next<uint64_t>() % config.key_count_];
+
+      std::vector<Uint64> offsets;
+
+      // retrieve tuple locations in reverse key order
+      data_index->scan_reverse(key, offsets);
+
+    } else if (next_rand < config.read_ratio_) {
       KeyT key = query_keys[rand_gen.next<uint64_t>() % config.key_count_];
 
       std::vector<Uint64> offsets;
@@ -263,16 +437,77 @@ void run_thread(const size_t &thread_id, const Config &config, const KeyT *query
   }
 }
 
+// measure single-thread range lookup throughput at increasing selectivities.
+// the time duration is evenly divided among all the measured selectivities.
+template<typename KeyT, typename ValueT>
+void run_range_sweep(const Config &config, const KeyT *sorted_keys, BaseIndex<KeyT, ValueT> *data_index) {
+
+  const double selectivities[] = { 0.00001, 0.0001, 0.001, 0.01, 0.1 };
+  const size_t selectivity_count = sizeof(selectivities) / sizeof(double);
+
+  long long duration_us = config.time_duration_ * 1000 * 1000 / selectivity_count;
+
+  FastRandom rand_gen(0);
+  TimeMeasurer timer;
+
+  std::cout << " SELECTIVITY    RANGE WIDTH    THROUGHPUT    AVG. RESULT SIZE" << std::endl;
+
+  for (size_t i = 0; i < selectivity_count; ++i) {
+
+    uint64_t range_width = get_range_width(config.key_count_, selectivities[i]);
+
+    uint64_t operation_count = 0;
+    uint64_t result_count = 0;
+
+    timer.tic();
+    while (true) {
+      std::vector<Uint64> offsets;
+
+      range_lookup(sorted_keys, config.key_count_, range_width, rand_gen, data_index, offsets);
+
+      result_count += offsets.size();
+      ++operation_count;
+
+      // check elapsed time every 64 lookups
+      if (operation_count % 64 == 0) {
+        timer.toc();
+        if (timer.time_us() >= duration_us) { break; }
+      }
+    }
+
+    std::cout << std::fixed << std::setprecision(5) << std::right
+              << std::setw(12) << selectivities[i] << "  |  "
+              << std::setw(10) << range_width << "  |  "
+              << std::setprecision(2)
+              << std::setw(7) << operation_count * 1.0 / timer.time_us() * 1000 << " K  |  "
+              << std::setw(10) << result_count * 1.0 / operation_count
+              << std::endl;
+  }
+}
+
 template<typename KeyT, typename ValueT>
 void run_workload(const Config &config) {
 
   // create table
   std::unique_ptr<DataTable<KeyT, ValueT>> data_table(nullptr);
-  data_table.reset(new DataTable<KeyT, ValueT>());
+  data_table.reset(new DataTable<KeyT, ValueT>(config.block_capacity_, config.block_placement_type_, config.table_layout_type_));
 
   // create index
   std::unique_ptr<BaseIndex<KeyT, ValueT>> data_index(nullptr);
-  data_index.reset(create_numeric_index<KeyT, ValueT>(config.index_type_, data_table.get(), config.index_param_1_, config.index_param_2_));
+  if (config.merge_threshold_ != 0) {
+    static_index::DeltaIndex<KeyT, ValueT> *delta_index = dynamic_cast<static_index::DeltaIndex<KeyT, ValueT>*>(
+      create_delta_index<KeyT, ValueT>(config.index_type_, data_table.get(), config.merge_threshold_, config.index_param_1_, config.index_param_2_, config.layout_type_));
+    delta_index->set_allocation_type(config.allocation_type_);
+    data_index.reset(delta_index);
+  } else {
+    data_index.reset(create_numeric_index<KeyT, ValueT>(config.index_type_, data_table.get(), config.index_param_1_, config.index_param_2_, config.layout_type_));
+  }
+
+  // static indexes allocate their arrays when reorganized
+  BaseStaticIndex<KeyT, ValueT> *static_index = dynamic_cast<BaseStaticIndex<KeyT, ValueT>*>(data_index.get());
+  if (static_index != nullptr) {
+    static_index->set_allocation_type(config.allocation_type_);
+  }
 
   // prepare threads
   data_index->prepare_threads(config.thread_count_);
@@ -297,8 +532,23 @@ void run_workload(const Config &config) {
     // record init input keys
     init_keys[i] = key;
   }
+  TimeMeasurer reorganize_timer;
+  reorganize_timer.tic();
+
   data_index->reorganize();
 
+  reorganize_timer.toc();
+  std::cout << "reorganize time: " << reorganize_timer.time_ms() << " ms" << std::endl;
+
+  // report the footprint of the sorted entries held by static indexes
+  if (static_index != nullptr) {
+    double aos_size_mb = static_index->get_storage_size(StaticLayoutType::AoSLayoutType) * 1.0 / 1024 / 1024;
+    double curr_size_mb = static_index->get_storage_size(static_index->get_layout_type()) * 1.0 / 1024 / 1024;
+    std::cout << "static storage size: " << curr_size_mb << " MB" 
+              << " (saved " << (aos_size_mb - curr_size_mb) << " MB against " 
+              << get_static_layout_name(StaticLayoutType::AoSLayoutType) << ")" << std::endl;
+  }
+
   double query_key_size_mb = config.key_count_ * sizeof(KeyT) * 1.0 / 1024 / 1024;
   //=================================
 
@@ -319,15 +569,31 @@ void run_workload(const Config &config) {
   }
   //=================================
 
+  // range lookups pick their bounds from the sorted keys
+  if (config.index_read_type_ == ReadType::IndexRangeLookupType || config.range_sweep_ == true) {
+    std::sort(init_keys, init_keys + config.key_count_);
+  }
+
+  if (config.range_sweep_ == true) {
+
+    run_range_sweep<KeyT, ValueT>(config, init_keys, data_index.get());
+
+    delete[] init_keys;
+    init_keys = nullptr;
+    return;
+  }
+
   //=================================
 
-  operation_counts = new uint64_t[config.thread_count_];
+  size_t thread_count = config.thread_count_;
+
+  operation_counts = new uint64_t[thread_count];
   uint64_t profile_round = (uint64_t)(config.time_duration_ / config.profile_duration_);
 
   uint64_t **operation_counts_profiles = new uint64_t*[profile_round];
   for (uint64_t round_id = 0; round_id < profile_round; ++round_id) {
-    operation_counts_profiles[round_id] = new uint64_t[config.thread_count_];
-    memset(operation_counts_profiles[round_id], 0, config.thread_count_ * sizeof(uint64_t));
+    operation_counts_profiles[round_id] = new uint64_t[thread_count];
+    memset(operation_counts_profiles[round_id], 0, thread_count * sizeof(uint64_t));
   }
   std::vector<double> act_size_profiles; // actual allocated size. Unit: MB. include both index and table
   std::vector<double> table_size_profiles; // table data size. Unit: #tuples.
@@ -344,7 +610,7 @@ void run_workload(const Config &config) {
   // PAPIProfiler::init_papi();
   // PAPIProfiler::start_measure_cache_miss_rate();
   
-  for (uint64_t thread_id = 0; thread_id < config.thread_count_; ++thread_id) {
+  for (uint64_t thread_id = 0; thread_id < thread_count; ++thread_id) {
     worker_threads.push_back(std::move(std::thread(run_thread<KeyT, ValueT>, thread_id, std::ref(config), init_keys, data_table.get(), data_index.get())));
   }
 
@@ -353,7 +619,7 @@ void run_workload(const Config &config) {
   for (uint64_t round_id = 0; round_id < profile_round; ++round_id) {
     std::this_thread::sleep_for(std::chrono::milliseconds(int(config.profile_duration_ * 1000)));
     
-    memcpy(operation_counts_profiles[round_id], operation_counts, sizeof(uint64_t) * config.thread_count_);
+    memcpy(operation_counts_profiles[round_id], operation_counts, sizeof(uint64_t) * thread_count);
 
     double table_size_approx = data_table->size_approx() * (sizeof(KeyT) + sizeof(ValueT)) * 1.0 / 1024 / 1024;
 
@@ -363,7 +629,7 @@ void run_workload(const Config &config) {
     if (round_id == 0) {
       // first round
       uint64_t operation_count = 0;
-      for (size_t thread_id = 0; thread_id < config.thread_count_; ++thread_id) {
+      for (size_t thread_id = 0; thread_id < thread_count; ++thread_id) {
         operation_count += operation_counts_profiles[0][thread_id];
       }
       total_operation_counts.push_back(operation_count);
@@ -371,7 +637,7 @@ void run_workload(const Config &config) {
     } else {
       // remaining rounds
       uint64_t operation_count = 0;
-      for (size_t thread_id = 0; thread_id < config.thread_count_; ++thread_id) {
+      for (size_t thread_id = 0; thread_id < thread_count; ++thread_id) {
         operation_count += operation_counts_profiles[round_id][thread_id] - operation_counts_profiles[round_id - 1][thread_id];
       }
       total_operation_counts.push_back(operation_count);
@@ -406,14 +672,14 @@ void run_workload(const Config &config) {
   // join all the threads
   is_running = false;
 
-  for (uint64_t i = 0; i < config.thread_count_; ++i) {
+  for (uint64_t i = 0; i < thread_count; ++i) {
     worker_threads.at(i).join();
   }
 
   // PAPIProfiler::stop_measure_cache_miss_rate();
   
   uint64_t total_count = 0;
-  for (uint64_t i = 0; i < config.thread_count_; ++i) {
+  for (uint64_t i = 0; i < thread_count; ++i) {
     total_count += operation_counts[i];
   }
 
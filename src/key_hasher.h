@@ -0,0 +1,191 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+
+#include "cityhash.h"
+
+// hash functions over key bytes, used as hasher policies of hash indexes.
+// each hasher provides hash_bytes() for any key size, and hash8() and hash16() for
+// keys of exactly 8 and 16 bytes, given as little-endian words. hash_key() picks
+// the fast paths at run time, FixedSizeHasher at compile time, so that the same
+// bytes hash to the same value either way.
+
+inline uint64_t load_word(const char *data) {
+  uint64_t word;
+  memcpy(&word, data, sizeof(word));
+  return word;
+}
+
+inline uint64_t load_half_word(const char *data) {
+  uint32_t half_word;
+  memcpy(&half_word, data, sizeof(half_word));
+  return half_word;
+}
+
+// CityHash64 from cityhash.cc
+struct CityHasher {
+
+  static inline uint64_t hash_bytes(const char *data, const size_t size) {
+    return CityHash64(data, size);
+  }
+
+  static inline uint64_t hash8(const uint64_t word) {
+    return CityHash64((const char*)&word, sizeof(word));
+  }
+
+  static inline uint64_t hash16(const uint64_t lo_word, const uint64_t hi_word) {
+    const uint64_t words[2] = { lo_word, hi_word };
+    return CityHash64((const char*)words, sizeof(words));
+  }
+};
+
+// wyhash-style hasher: keys are read in at most two overlapping loads per 16 bytes,
+// and mixed by folding the 128-bit product of two words.
+struct WyHasher {
+
+  static const uint64_t SECRET0 = 0xa0761d6478bd642full;
+  static const uint64_t SECRET1 = 0xe7037ed1a0b428dbull;
+
+  static inline uint64_t mix(const uint64_t lhs, const uint64_t rhs) {
+    __uint128_t product = (__uint128_t)lhs * rhs;
+    return (uint64_t)product ^ (uint64_t)(product >> 64);
+  }
+
+  static inline uint64_t hash_bytes(const char *data, const size_t size) {
+    uint64_t seed = SECRET0;
+    uint64_t lo_word = 0;
+    uint64_t hi_word = 0;
+
+    if (size <= 16) {
+      if (size >= 4) {
+        // the four loads cover all bytes, whether size is below 8 or not
+        size_t step = (size >> 3) << 2;
+        lo_word = (load_half_word(data) << 32) | load_half_word(data + step);
+        hi_word = (load_half_word(data + size - 4) << 32) | load_half_word(data + size - 4 - step);
+      } else if (size > 0) {
+        const uint8_t *bytes = (const uint8_t*)data;
+        lo_word = ((uint64_t)bytes[0] << 16) | ((uint64_t)bytes[size >> 1] << 8) | bytes[size - 1];
+      }
+    } else {
+      size_t rest = size;
+      while (rest > 16) {
+        seed = mix(load_word(data) ^ SECRET1, load_word(data + 8) ^ seed);
+        data += 16;
+        rest -= 16;
+      }
+      // the last 16 bytes, overlapping the previous round if needed
+      lo_word = load_word(data + rest - 16);
+      hi_word = load_word(data + rest - 8);
+    }
+    return mix(SECRET1 ^ size, mix(lo_word ^ SECRET1, hi_word ^ seed));
+  }
+
+  static inline uint64_t hash8(const uint64_t word) {
+    return mix(SECRET1 ^ sizeof(word), mix(word ^ SECRET1, word ^ SECRET0));
+  }
+
+  static inline uint64_t hash16(const uint64_t lo_word, const uint64_t hi_word) {
+    return mix(SECRET1 ^ 16, mix(lo_word ^ SECRET1, hi_word ^ SECRET0));
+  }
+};
+
+// hasher on the crc32 instruction of SSE4.2 (CRC32C), one word per instruction.
+// the crc is seeded with the key size, so zero padding of the last word is safe,
+// and spread over 64 bits by a multiplication.
+// without SSE4.2, it falls back to WyHasher.
+struct Crc32cHasher {
+
+  static const uint64_t MULTIPLIER = 0x9e3779b97f4a7c15ull;
+
+#if defined(__SSE4_2__)
+  static inline uint64_t hash_bytes(const char *data, const size_t size) {
+    uint64_t crc = size;
+    size_t rest = size;
+    while (rest >= 8) {
+      crc = _mm_crc32_u64(crc, load_word(data));
+      data += 8;
+      rest -= 8;
+    }
+    if (rest > 0) {
+      uint64_t word = 0;
+      memcpy(&word, data, rest);
+      crc = _mm_crc32_u64(crc, word);
+    }
+    return finalize(crc);
+  }
+
+  static inline uint64_t hash8(const uint64_t word) {
+    return finalize(_mm_crc32_u64(sizeof(word), word));
+  }
+
+  static inline uint64_t hash16(const uint64_t lo_word, const uint64_t hi_word) {
+    return finalize(_mm_crc32_u64(_mm_crc32_u64(16, lo_word), hi_word));
+  }
+#else
+  static inline uint64_t hash_bytes(const char *data, const size_t size) {
+    return WyHasher::hash_bytes(data, size);
+  }
+
+  static inline uint64_t hash8(const uint64_t word) {
+    return WyHasher::hash8(word);
+  }
+
+  static inline uint64_t hash16(const uint64_t lo_word, const uint64_t hi_word) {
+    return WyHasher::hash16(lo_word, hi_word);
+  }
+#endif
+
+private:
+  // the crc only has 32 bits, placed in the high half and mixed into the low half
+  static inline uint64_t finalize(const uint64_t crc) {
+    uint64_t hash = crc * MULTIPLIER;
+    return hash ^ (hash >> 32);
+  }
+};
+
+typedef WyHasher DefaultHasher;
+
+template<typename HasherT>
+inline uint64_t hash_key(const char *data, const size_t size) {
+  if (size == 8) {
+    return HasherT::hash8(load_word(data));
+  }
+  if (size == 16) {
+    return HasherT::hash16(load_word(data), load_word(data + 8));
+  }
+  return HasherT::hash_bytes(data, size);
+}
+
+template<typename HasherT, size_t KeySize>
+struct FixedSizeHasher {
+  static inline uint64_t hash(const char *data) {
+    return HasherT::hash_bytes(data, KeySize);
+  }
+};
+
+template<typename HasherT>
+struct FixedSizeHasher<HasherT, 8> {
+  static inline uint64_t hash(const char *data) {
+    return HasherT::hash8(load_word(data));
+  }
+};
+
+template<typename HasherT>
+struct FixedSizeHasher<HasherT, 16> {
+  static inline uint64_t hash(const char *data) {
+    return HasherT::hash16(load_word(data), load_word(data + 8));
+  }
+};
+
+// hashes the bytes of fixed-size numeric keys
+template<typename KeyT, typename HasherT = DefaultHasher>
+struct NumericKeyHasher {
+  inline std::size_t operator()(const KeyT &key) const {
+    return FixedSizeHasher<HasherT, sizeof(KeyT)>::hash((const char*)&key);
+  }
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include <sys/mman.h>
+#include <mm_malloc.h>
+
+#include "utils.h"
+
+// how static indexes allocate their sorted entries and inner nodes.
+enum class StaticAllocationType {
+  // cacheline-aligned heap memory
+  DefaultAllocationType = 0,
+  // memory backed by 2MB transparent huge pages, so that random probes
+  // into large arrays miss the TLB less often
+  HugePageAllocationType,
+};
+
+static std::string get_static_allocation_name(const StaticAllocationType allocation_type) {
+  if (allocation_type == StaticAllocationType::DefaultAllocationType) {
+    return "default pages";
+  } else if (allocation_type == StaticAllocationType::HugePageAllocationType) {
+    return "huge pages";
+  } else {
+    ASSERT(false, "invalid allocation type");
+    return "";
+  }
+}
+
+static const size_t HUGE_PAGE_SIZE = 1ull << 21; // unit: byte (2 MB)
+
+// every array is preceded by a header telling how to release it.
+// the header takes a whole cacheline, so that arrays stay cacheline-aligned.
+static const size_t STATIC_ARRAY_HEADER_SIZE = 64; // unit: byte
+
+struct StaticArrayHeader {
+  // start of the allocation that holds the array
+  char *base_;
+  // size of the mapping that holds the array, or 0 if the array is on the heap
+  size_t mapped_size_;
+};
+
+// allocate size bytes, aligned to alignment, which is a power of two no smaller
+// than a cacheline and no larger than a huge page. the array starts alignment bytes
+// after the start of the allocation, and the header is right before the array.
+// with huge pages, the array is mapped at a huge page boundary and advised to be
+// backed by transparent huge pages. if the mapping fails, the heap is used instead;
+// if the kernel ignores the advice, the mapping is backed by normal pages.
+static void* allocate_static_array(const size_t size, const StaticAllocationType allocation_type, const size_t alignment = STATIC_ARRAY_HEADER_SIZE) {
+
+  ASSERT(alignment >= STATIC_ARRAY_HEADER_SIZE && alignment <= HUGE_PAGE_SIZE && (alignment & (alignment - 1)) == 0, "invalid alignment: " << alignment);
+
+  if (allocation_type == StaticAllocationType::HugePageAllocationType) {
+
+    size_t mapped_size = (size + alignment + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+
+    // map one more huge page, and trim the mapping to a huge page boundary
+    char *region = (char*)mmap(nullptr, mapped_size + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (region != MAP_FAILED) {
+      char *base = (char*)(((uintptr_t)region + HUGE_PAGE_SIZE - 1) & ~(uintptr_t)(HUGE_PAGE_SIZE - 1));
+
+      if (base != region) {
+        munmap(region, base - region);
+      }
+      size_t tail_size = (region + mapped_size + HUGE_PAGE_SIZE) - (base + mapped_size);
+      if (tail_size != 0) {
+        munmap(base + mapped_size, tail_size);
+      }
+
+#if defined(MADV_HUGEPAGE)
+      madvise(base, mapped_size, MADV_HUGEPAGE);
+#endif
+
+      StaticArrayHeader *header = (StaticArrayHeader*)(base + alignment - STATIC_ARRAY_HEADER_SIZE);
+      header->base_ = base;
+      header->mapped_size_ = mapped_size;
+      return base + alignment;
+    }
+  }
+
+  char *base = (char*)_mm_malloc(size + alignment, alignment);
+  ASSERT(base != nullptr, "failed to allocate " << size << " bytes");
+
+  StaticArrayHeader *header = (StaticArrayHeader*)(base + alignment - STATIC_ARRAY_HEADER_SIZE);
+  header->base_ = base;
+  header->mapped_size_ = 0;
+  return base + alignment;
+}
+
+static void free_static_array(void *ptr) {
+  if (ptr == nullptr) { return; }
+
+  StaticArrayHeader *header = (StaticArrayHeader*)((char*)ptr - STATIC_ARRAY_HEADER_SIZE);
+  char *base = header->base_;
+  size_t mapped_size = header->mapped_size_;
+
+  if (mapped_size != 0) {
+    munmap(base, mapped_size);
+  } else {
+    _mm_free(base);
+  }
+}
@@ -11,11 +11,11 @@ template<typename KeyT, typename ValueT>
 class BinaryIndex : public BaseStaticIndex<KeyT, ValueT> {
 
 public:
-  BinaryIndex(DataTable<KeyT, ValueT> *table_ptr, const size_t num_layers) : BaseStaticIndex<KeyT, ValueT>(table_ptr), num_layers_(num_layers) {}
+  BinaryIndex(DataTable<KeyT, ValueT> *table_ptr, const size_t num_layers, const StaticLayoutType layout_type = StaticLayoutType::AoSLayoutType) : BaseStaticIndex<KeyT, ValueT>(table_ptr, layout_type), num_layers_(num_layers), inner_nodes_(nullptr) {}
 
   virtual ~BinaryIndex() {
     if (num_layers_ != 0) {
-      delete[] inner_nodes_;
+      this->free_array(inner_nodes_);
       inner_nodes_ = nullptr;
     }
   }
@@ -32,53 +32,50 @@ public:
     if (key_max_ == key_min_) {
       if (key_max_ == key) {
         for (size_t i = 0; i < this->size_; ++i) {
-          offsets.push_back(this->container_[i].offset_);
+          offsets.push_back(this->offset_at(i));
         }
       }
       return;
     }
 
-    size_t offset_find = this->size_;
-    std::pair<int, int> offset_range = find_inner_layers(key);
-    if (offset_range.first == offset_range.second) {
-      offset_find = offset_range.first;
-    } else {
-      offset_find = find_internal(key, offset_range.first, offset_range.second);
+    // the first entry matching key is the lower bound of key
+    size_t offset_find = find_lower_bound(key);
+
+    while (offset_find < this->size_ && this->key_at(offset_find) == key) {
+      offsets.push_back(this->offset_at(offset_find));
+      ++offset_find;
     }
+  }
 
-    if (offset_find == this->size_) {
-      // find nothing
+  // inner layers are small and stay cached, so each lookup descends them on its own.
+  // the searches over the sorted entries, which miss the cache, are then interleaved.
+  virtual void find_batch(const KeyT *keys, const size_t count, std::vector<Uint64> *offsets) final {
+
+    if (this->size_ == 0) {
       return;
     }
 
-    offsets.push_back(this->container_[offset_find].offset_);
+    std::vector<size_t> begin_offsets(count);
+    std::vector<size_t> end_offsets(count);
 
-    // move left
-    int offset_find_lhs = offset_find - 1;
-    while (offset_find_lhs >= 0) {
-
-      if (this->container_[offset_find_lhs].key_ == key) {
-        offsets.push_back(this->container_[offset_find_lhs].offset_);
-        offset_find_lhs -= 1;
-      } else {
-        break;
+    for (size_t i = 0; i < count; ++i) {
+      if (keys[i] > key_max_ || keys[i] < key_min_ || key_max_ == key_min_) {
+        // the lower bound is the first entry, which matches only if all keys are equal
+        begin_offsets[i] = 0;
+        end_offsets[i] = 0;
+        continue;
       }
+      std::pair<int64_t, int64_t> offset_range = find_inner_layers(keys[i], false);
+      begin_offsets[i] = offset_range.first;
+      end_offsets[i] = offset_range.second + 1;
     }
-    // move right
-    int offset_find_rhs = offset_find + 1;
-    while (offset_find_rhs <= this->size_ - 1) {
 
-      if (this->container_[offset_find_rhs].key_ == key) {
-        offsets.push_back(this->container_[offset_find_rhs].offset_);
-        offset_find_rhs += 1;
-      } else {
-        break;
-      }
-    }
+    this->base_find_batch(keys, count, begin_offsets.data(), end_offsets.data(), offsets);
   }
 
   virtual void find_range(const KeyT &lhs_key, const KeyT &rhs_key, std::vector<Uint64> &offsets) final {
-    assert(lhs_key < rhs_key);
+
+    if (lhs_key > rhs_key) { return; }
 
     if (this->size_ == 0) {
       return;
@@ -87,6 +84,10 @@ public:
       return;
     }
 
+    size_t lhs_offset = find_lower_bound(lhs_key);
+    size_t rhs_offset = find_upper_bound(rhs_key);
+
+    this->base_copy_offsets(lhs_offset, rhs_offset, offsets);
   }
 
   virtual void reorganize() final {
@@ -97,12 +98,12 @@ public:
 
     ASSERT(inner_node_count_ < this->size_, "exceed maximum layers");
 
-    key_min_ = this->container_[0].key_;
-    key_max_ = this->container_[this->size_ - 1].key_;
+    key_min_ = this->key_at(0);
+    key_max_ = this->key_at(this->size_ - 1);
     
     if (num_layers_ != 0) {
 
-      inner_nodes_ = new KeyT[inner_node_count_];
+      inner_nodes_ = this->template allocate_array<KeyT>(inner_node_count_);
       construct_inner_layers();
 
     } else {
@@ -111,6 +112,11 @@ public:
 
   }
 
+  // the inner layers need fewer nodes than entries
+  virtual size_t get_min_size() const final {
+    return (size_t)1 << num_layers_;
+  }
+
   virtual void print() const final {
     if (inner_nodes_ != nullptr) {
 
@@ -123,96 +129,95 @@ public:
 
 private: 
 
+  // build inner nodes layer by layer.
+  // nodes in a layer cover disjoint ranges, so each layer is built in parallel.
   void construct_inner_layers() {
     ASSERT (num_layers_ != 0, "number of layers cannot be 0");
 
-    size_t begin_offset = 0;
-    size_t end_offset = this->size_ - 1;
-    size_t mid_offset = (begin_offset + end_offset) / 2;
-    
-    inner_nodes_[0] = this->container_[mid_offset].key_;
-    if (num_layers_ == 1) { return; }
+    // offset ranges covered by the nodes in the current layer
+    std::vector<std::pair<int64_t, int64_t>> curr_ranges(1, std::pair<int64_t, int64_t>(0, this->size_ - 1));
+    std::vector<std::pair<int64_t, int64_t>> next_ranges;
 
-    size_t base_pos = 1;
-    size_t next_layer = 1;
-    construct_inner_layers_internal(begin_offset, mid_offset - 1, base_pos, 0, next_layer);
-    construct_inner_layers_internal(mid_offset + 1, end_offset, base_pos, 1, next_layer);
-  }
+    size_t base_pos = 0;
 
-  void construct_inner_layers_internal(const int begin_offset, const int end_offset, const size_t base_pos, const size_t dst_pos, const size_t curr_layer) {
-    if (begin_offset > end_offset) { return; }
+    for (size_t curr_layer = 0; curr_layer < num_layers_; ++curr_layer) {
+      bool is_last_layer = (curr_layer + 1 == num_layers_);
+      if (!is_last_layer) {
+        next_ranges.resize(curr_ranges.size() * 2);
+      }
 
-    size_t mid_offset = (begin_offset + end_offset) / 2;
-  
-    ASSERT(base_pos + dst_pos < inner_node_count_, 
-      "out of array: " << (base_pos + dst_pos) << " " << inner_node_count_);
+      this->parallel_for(curr_ranges.size(), this->PARALLEL_GRAIN_SIZE, [&](const size_t begin_pos, const size_t end_pos) {
+        for (size_t dst_pos = begin_pos; dst_pos < end_pos; ++dst_pos) {
+          int64_t begin_offset = curr_ranges[dst_pos].first;
+          int64_t end_offset = curr_ranges[dst_pos].second;
 
-    inner_nodes_[base_pos + dst_pos] = this->container_[mid_offset].key_;
+          int64_t mid_offset = (begin_offset + end_offset) / 2;
 
-    if (num_layers_ == curr_layer + 1) { return; }
+          if (begin_offset <= end_offset) {
+            ASSERT(base_pos + dst_pos < inner_node_count_, 
+              "out of array: " << (base_pos + dst_pos) << " " << inner_node_count_);
 
-    size_t new_base_pos = (base_pos + 1) * 2 - 1;
+            inner_nodes_[base_pos + dst_pos] = this->key_at(mid_offset);
+          } else {
+            // children of an empty node are empty
+            mid_offset = end_offset;
+          }
 
-    construct_inner_layers_internal(begin_offset, mid_offset - 1, new_base_pos, dst_pos * 2, curr_layer + 1);
-    construct_inner_layers_internal(mid_offset + 1, end_offset, new_base_pos, dst_pos * 2 + 1, curr_layer + 1);
-  }
+          if (!is_last_layer) {
+            next_ranges[dst_pos * 2] = std::pair<int64_t, int64_t>(begin_offset, mid_offset - 1);
+            next_ranges[dst_pos * 2 + 1] = std::pair<int64_t, int64_t>(mid_offset + 1, end_offset);
+          }
+        }
+      });
 
-  // find in leaf nodes, simple binary search
-  size_t find_internal(const KeyT &key, const int offset_begin, const int offset_end) {
-    if (offset_begin > offset_end) {
-      return this->size_;
-    }
-    int offset_lookup = (offset_begin + offset_end) / 2;
-    KeyT key_lookup = this->container_[offset_lookup].key_;
-    if (key == key_lookup) {
-      return offset_lookup;
-    }
-    if (key > key_lookup) {
-      return find_internal(key, offset_lookup + 1, offset_end);
-    } else {
-      return find_internal(key, offset_begin, offset_lookup - 1);
+      curr_ranges.swap(next_ranges);
+      base_pos = (base_pos + 1) * 2 - 1;
     }
   }
 
-  // find in inner nodes
-  std::pair<int, int> find_inner_layers(const KeyT &key) {
-
-    if (num_layers_ == 0) { return std::pair<int, int>(0, this->size_); }
-
-    int begin_offset = 0;
-    int end_offset = this->size_ - 1;
-    int mid_offset = (begin_offset + end_offset) / 2;
-    if (key == inner_nodes_[0]) { return std::pair<int, int>(mid_offset, mid_offset); }
-
-    size_t base_pos = 1;
-    size_t next_layer = 1;
+  virtual size_t find_bound(const KeyT &key, const bool is_upper) final {
+    return is_upper ? find_upper_bound(key) : find_lower_bound(key);
+  }
 
-    if (key < inner_nodes_[0]) {
-      return find_inner_layers_internal(key, begin_offset, mid_offset - 1, base_pos, 0, next_layer);
-    } else {
-      return find_inner_layers_internal(key, mid_offset + 1, end_offset, base_pos, 1, next_layer);
-    }
+  // return the first offset whose key is no less than key.
+  size_t find_lower_bound(const KeyT &key) {
+    std::pair<int64_t, int64_t> offset_range = find_inner_layers(key, false);
+    return this->base_lower_bound(key, offset_range.first, offset_range.second + 1);
+  }
 
+  // return the first offset whose key is larger than key.
+  size_t find_upper_bound(const KeyT &key) {
+    std::pair<int64_t, int64_t> offset_range = find_inner_layers(key, true);
+    return this->base_upper_bound(key, offset_range.first, offset_range.second + 1);
   }
 
-  // helper function for find_inner_layers()
-  std::pair<int, int> find_inner_layers_internal(const KeyT &key, const int begin_offset, const int end_offset, const size_t base_pos, const size_t dst_pos, const size_t curr_layer) {
+  // descend inner nodes to the leaf range [first, second] holding the bound.
+  // the bound is either in this range or right after it.
+  std::pair<int64_t, int64_t> find_inner_layers(const KeyT &key, const bool is_upper = false) {
 
-    if (num_layers_ == curr_layer) { return std::pair<int, int>(begin_offset, end_offset); }
+    int64_t begin_offset = 0;
+    int64_t end_offset = this->size_ - 1;
+    size_t base_pos = 0;
+    size_t dst_pos = 0;
 
-    int mid_offset = (begin_offset + end_offset) / 2;
-    if (key == inner_nodes_[base_pos + dst_pos]) { return std::pair<int, int>(mid_offset, mid_offset); }
+    for (size_t curr_layer = 0; curr_layer < num_layers_; ++curr_layer) {
+      int64_t mid_offset = (begin_offset + end_offset) / 2;
+      KeyT inner_key = inner_nodes_[base_pos + dst_pos];
 
-    int new_base_pos = (base_pos + 1) * 2 - 1;
+      base_pos = (base_pos + 1) * 2 - 1;
 
-    if (key < inner_nodes_[base_pos + dst_pos]) {
-      return find_inner_layers_internal(key, begin_offset, mid_offset - 1, new_base_pos, dst_pos * 2, curr_layer + 1);
-    } else {
-      return find_inner_layers_internal(key, mid_offset + 1, end_offset, new_base_pos, dst_pos * 2 + 1, curr_layer + 1);
+      if (key < inner_key || (!is_upper && key == inner_key)) {
+        end_offset = mid_offset - 1;
+        dst_pos = dst_pos * 2;
+      } else {
+        begin_offset = mid_offset + 1;
+        dst_pos = dst_pos * 2 + 1;
+      }
     }
-
+    return std::pair<int64_t, int64_t>(begin_offset, end_offset);
   }
 
+
 private:
 
   size_t num_layers_;
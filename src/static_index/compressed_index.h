@@ -0,0 +1,280 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+
+#include "base_static_index.h"
+
+namespace static_index {
+
+// static index over frame-of-reference compressed keys.
+// sorted keys are cut into blocks of block_size_ keys. a block stores its first key
+// as the base, and every key as its difference to the base, bit-packed with the
+// smallest width that holds the largest difference in the block.
+// the bases of all blocks form a sparse top level: a lookup binary searches the bases
+// to pick a block, then binary searches the packed differences in place.
+// any difference is unpacked from two words with shifts only, so no block is decoded
+// as a whole. offsets are kept uncompressed, and only touched on a hit.
+template<typename KeyT, typename ValueT>
+class CompressedIndex : public BaseStaticIndex<KeyT, ValueT> {
+
+  struct BlockMeta {
+
+    BlockMeta() : word_begin_(0), mask_(0), bit_width_(0) {}
+
+    // first word of the packed differences
+    size_t word_begin_;
+    // mask of bit_width_ low bits
+    Uint64 mask_;
+    size_t bit_width_;
+  };
+
+public:
+  CompressedIndex(DataTable<KeyT, ValueT> *table_ptr, const size_t block_size)
+    : BaseStaticIndex<KeyT, ValueT>(table_ptr, StaticLayoutType::SoALayoutType)
+    , block_size_(block_size)
+    , block_shift_(0)
+    , num_blocks_(0)
+    , block_bases_(nullptr)
+    , block_metas_(nullptr)
+    , words_(nullptr)
+    , num_words_(0) {
+
+    ASSERT(block_size_ >= 1 && (block_size_ & (block_size_ - 1)) == 0, "block size must be a power of two");
+
+    while (((size_t)1 << block_shift_) < block_size_) {
+      ++block_shift_;
+    }
+  }
+
+  virtual ~CompressedIndex() {
+    this->free_array(block_bases_);
+    block_bases_ = nullptr;
+
+    this->free_array(block_metas_);
+    block_metas_ = nullptr;
+
+    this->free_array(words_);
+    words_ = nullptr;
+  }
+
+  virtual void find(const KeyT &key, std::vector<Uint64> &offsets) final {
+
+    if (this->size_ == 0) {
+      return;
+    }
+
+    if (key > key_max_ || key < key_min_) {
+      return;
+    }
+
+    // the first entry matching key is the lower bound of key
+    size_t offset_find = find_bound(key, false);
+
+    while (offset_find < this->size_ && get_key(offset_find) == key) {
+      offsets.push_back(this->offset_at(offset_find));
+      ++offset_find;
+    }
+  }
+
+  virtual void find_range(const KeyT &lhs_key, const KeyT &rhs_key, std::vector<Uint64> &offsets) final {
+
+    if (lhs_key > rhs_key) { return; }
+
+    if (this->size_ == 0) {
+      return;
+    }
+    if (lhs_key > key_max_ || rhs_key < key_min_) {
+      return;
+    }
+
+    size_t lhs_offset = find_bound(lhs_key, false);
+    size_t rhs_offset = find_bound(rhs_key, true);
+
+    this->base_copy_offsets(lhs_offset, rhs_offset, offsets);
+  }
+
+  virtual void reorganize() final {
+
+    this->base_reorganize();
+
+    key_min_ = this->key_at(0);
+    key_max_ = this->key_at(this->size_ - 1);
+
+    num_blocks_ = (this->size_ + block_size_ - 1) >> block_shift_;
+
+    block_bases_ = this->template allocate_array<KeyT>(num_blocks_);
+    block_metas_ = this->template allocate_array<BlockMeta>(num_blocks_);
+
+    // pick the bit width of each block
+    this->parallel_for(num_blocks_, 1, [&](const size_t begin_block, const size_t end_block) {
+      for (size_t i = begin_block; i < end_block; ++i) {
+        KeyT base = this->key_at(i << block_shift_);
+        Uint64 max_diff = get_diff(this->key_at(get_block_end(i) - 1), base);
+
+        size_t bit_width = 0;
+        while (bit_width < 64 && (max_diff >> bit_width) != 0) {
+          ++bit_width;
+        }
+
+        block_bases_[i] = base;
+        block_metas_[i].bit_width_ = bit_width;
+        block_metas_[i].mask_ = (bit_width == 64) ? ~(Uint64)0 : (((Uint64)1 << bit_width) - 1);
+      }
+    });
+
+    // blocks start at word boundaries
+    num_words_ = 0;
+    for (size_t i = 0; i < num_blocks_; ++i) {
+      block_metas_[i].word_begin_ = num_words_;
+      num_words_ += (get_block_length(i) * block_metas_[i].bit_width_ + 63) / 64;
+    }
+
+    // two more words, so that unpacking may always read two words,
+    // even from an empty block at the end
+    words_ = this->template allocate_array<Uint64>(num_words_ + 2);
+    words_[num_words_] = 0;
+    words_[num_words_ + 1] = 0;
+
+    this->parallel_for(num_blocks_, 1, [&](const size_t begin_block, const size_t end_block) {
+      for (size_t i = begin_block; i < end_block; ++i) {
+        pack_block(i);
+      }
+    });
+
+    // keys are only read from the packed blocks from now on
+    this->free_array(this->keys_);
+    this->keys_ = nullptr;
+    this->key_base_ = nullptr;
+  }
+
+  virtual KeyT get_key(const size_t pos) const final {
+    size_t block_id = pos >> block_shift_;
+    return block_bases_[block_id] + (KeyT)unpack(block_metas_[block_id], pos & (block_size_ - 1));
+  }
+
+  virtual size_t get_storage_size(const StaticLayoutType layout_type) const final {
+    if (layout_type == StaticLayoutType::AoSLayoutType) {
+      return BaseStaticIndex<KeyT, ValueT>::get_storage_size(layout_type);
+    }
+    return get_key_storage_size() + this->size_ * sizeof(Uint64);
+  }
+
+  virtual void print() const final {
+    std::cout << "number of blocks = " << num_blocks_ << std::endl;
+    std::cout << "bits per key = " << get_key_storage_size() * 8.0 / this->size_ << std::endl;
+    std::cout << "key compression ratio = " << this->size_ * sizeof(KeyT) * 1.0 / get_key_storage_size() << std::endl;
+  }
+
+private:
+
+  static Uint64 get_diff(const KeyT &key, const KeyT &base) {
+    return (Uint64)key - (Uint64)base;
+  }
+
+  size_t get_block_end(const size_t block_id) const {
+    return std::min((block_id + 1) << block_shift_, this->size_);
+  }
+
+  size_t get_block_length(const size_t block_id) const {
+    return get_block_end(block_id) - (block_id << block_shift_);
+  }
+
+  size_t get_key_storage_size() const {
+    return num_blocks_ * (sizeof(KeyT) + sizeof(BlockMeta)) + (num_words_ + 2) * sizeof(Uint64);
+  }
+
+  void pack_block(const size_t block_id) {
+    const BlockMeta &meta = block_metas_[block_id];
+    size_t block_begin = block_id << block_shift_;
+    size_t length = get_block_length(block_id);
+
+    Uint64 *words = words_ + meta.word_begin_;
+    size_t num_words = (length * meta.bit_width_ + 63) / 64;
+    memset(words, 0, num_words * sizeof(Uint64));
+
+    for (size_t i = 0; i < length; ++i) {
+      Uint64 diff = get_diff(this->key_at(block_begin + i), block_bases_[block_id]);
+      size_t bit_pos = i * meta.bit_width_;
+      size_t word_pos = bit_pos >> 6;
+      size_t shift = bit_pos & 63;
+
+      words[word_pos] |= diff << shift;
+      if (shift + meta.bit_width_ > 64) {
+        words[word_pos + 1] |= diff >> (64 - shift);
+      }
+    }
+  }
+
+  // the pos-th difference of a block.
+  // the high part is shifted in two steps, which leaves nothing when shift is 0.
+  Uint64 unpack(const BlockMeta &meta, const size_t pos) const {
+    size_t bit_pos = pos * meta.bit_width_;
+    const Uint64 *words = words_ + meta.word_begin_ + (bit_pos >> 6);
+    size_t shift = bit_pos & 63;
+
+    Uint64 low = words[0] >> shift;
+    Uint64 high = (words[1] << 1) << (63 - shift);
+    return (low | high) & meta.mask_;
+  }
+
+  // return the lower (or upper) bound of key over all entries.
+  virtual size_t find_bound(const KeyT &key, const bool is_upper) final {
+
+    // number of blocks whose bases lie before the bound
+    size_t begin_block = 0;
+    size_t count = num_blocks_;
+    while (count > 1) {
+      size_t half = count / 2;
+      const KeyT &base = block_bases_[begin_block + half];
+      begin_block = (base < key || (is_upper && base == key)) ? begin_block + half : begin_block;
+      count -= half;
+    }
+    size_t num_preceding = begin_block + (block_bases_[begin_block] < key || (is_upper && block_bases_[begin_block] == key));
+
+    if (num_preceding == 0) {
+      return 0;
+    }
+
+    // the bound lies in the last preceding block, or begins the next block
+    size_t block_id = num_preceding - 1;
+    const BlockMeta &meta = block_metas_[block_id];
+    Uint64 diff = get_diff(key, block_bases_[block_id]);
+
+    size_t begin_pos = 0;
+    count = get_block_length(block_id);
+    while (count > 0) {
+      size_t half = count / 2;
+      Uint64 probe_diff = unpack(meta, begin_pos + half);
+      if (probe_diff < diff || (is_upper && probe_diff == diff)) {
+        begin_pos += half + 1;
+        count -= half + 1;
+      } else {
+        count = half;
+      }
+    }
+    return (block_id << block_shift_) + begin_pos;
+  }
+
+private:
+
+  // number of keys per block, a power of two
+  size_t block_size_;
+  size_t block_shift_;
+
+  size_t num_blocks_;
+
+  // first key of each block
+  KeyT *block_bases_;
+  BlockMeta *block_metas_;
+
+  // packed differences of all blocks
+  Uint64 *words_;
+  size_t num_words_;
+
+  KeyT key_min_;
+  KeyT key_max_;
+
+};
+
+}
@@ -0,0 +1,427 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <map>
+#include <pthread.h>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "base_static_index.h"
+
+namespace static_index {
+
+// updatable wrapper over a static index.
+// inserts and erases are absorbed into a small sorted delta, and lookups merge
+// the static base with the delta. once the delta has absorbed merge_threshold_
+// updates, it is frozen and merged with the base into a new static index by a
+// background thread, while later updates go to a fresh delta. the new index
+// replaces the base at the first update after the merge finishes.
+// the wrapped index may need a minimum number of entries, e.g., for its inner
+// layers. merges are deferred while the index holds fewer entries.
+// lookups share a reader-writer lock, and updates hold it exclusively, so updates
+// may run concurrently with lookups and with each other. the base is only replaced
+// under the exclusive lock, so no lookup is still reading the old base when it is freed.
+// the merge thread takes no lock: it only reads the base and the frozen delta,
+// which stay unchanged until the merged base is installed.
+template<typename KeyT, typename ValueT>
+class DeltaIndex : public BaseIndex<KeyT, ValueT> {
+
+  typedef BaseStaticIndex<KeyT, ValueT> StaticIndexT;
+  typedef std::function<StaticIndexT*()> StaticIndexFactory;
+
+  // updates of a key since the last merge.
+  struct DeltaEntry {
+
+    DeltaEntry() : erased_(false) {}
+
+    // whether entries of the key in older data are erased
+    bool erased_;
+    // offsets inserted after the latest erase
+    std::vector<Uint64> offsets_;
+  };
+
+  typedef std::map<KeyT, DeltaEntry> DeltaMap;
+
+public:
+  DeltaIndex(DataTable<KeyT, ValueT> *table_ptr, const StaticIndexFactory &factory, const size_t merge_threshold)
+    : BaseIndex<KeyT, ValueT>(table_ptr)
+    , factory_(factory)
+    , merge_threshold_(merge_threshold)
+    , min_size_(1)
+    , base_(nullptr)
+    , merged_base_(nullptr)
+    , is_merge_done_(false)
+    , update_count_(0)
+    , merge_count_(0)
+    , size_(0)
+    , thread_count_(1)
+    , allocation_type_(StaticAllocationType::DefaultAllocationType) {
+
+    ASSERT(merge_threshold_ >= 1, "merge threshold must be at least one");
+
+    // prefer writers, so that a steady stream of lookups does not starve updates
+    pthread_rwlockattr_t lock_attr;
+    pthread_rwlockattr_init(&lock_attr);
+#if defined(__GLIBC__)
+    pthread_rwlockattr_setkind_np(&lock_attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+    pthread_rwlock_init(&lock_, &lock_attr);
+    pthread_rwlockattr_destroy(&lock_attr);
+
+    StaticIndexT *index = factory_();
+    min_size_ = index->get_min_size();
+    delete index;
+  }
+
+  virtual ~DeltaIndex() {
+    if (merge_thread_.joinable()) {
+      merge_thread_.join();
+    }
+    delete merged_base_;
+    merged_base_ = nullptr;
+
+    delete base_;
+    base_ = nullptr;
+
+    pthread_rwlock_destroy(&lock_);
+  }
+
+  virtual void insert(const KeyT &key, const Uint64 &offset) final {
+    WriteGuard guard(lock_);
+
+    install_merged_base(false);
+
+    delta_[key].offsets_.push_back(offset);
+    ++size_;
+
+    count_update();
+  }
+
+  virtual void erase(const KeyT &key) final {
+    WriteGuard guard(lock_);
+
+    install_merged_base(false);
+
+    std::vector<Uint64> offsets;
+    find_entries(key, offsets);
+    size_ -= offsets.size();
+
+    DeltaEntry &entry = delta_[key];
+    entry.erased_ = true;
+    entry.offsets_.clear();
+
+    count_update();
+  }
+
+  virtual void find(const KeyT &key, std::vector<Uint64> &offsets) final {
+    ReadGuard guard(lock_);
+
+    find_entries(key, offsets);
+  }
+
+  // offsets are returned in key order. for each key, offsets in the base
+  // precede offsets inserted since the last merge.
+  virtual void find_range(const KeyT &lhs_key, const KeyT &rhs_key, std::vector<Uint64> &offsets) final {
+
+    if (lhs_key > rhs_key) { return; }
+
+    ReadGuard guard(lock_);
+
+    auto frozen_iter = frozen_delta_.lower_bound(lhs_key);
+    auto delta_iter = delta_.lower_bound(lhs_key);
+
+    // base entries in [curr_key, rhs_key] are not reported yet
+    KeyT curr_key = lhs_key;
+
+    while (true) {
+
+      // visit updated keys in [lhs_key, rhs_key] in key order
+      bool has_frozen = (frozen_iter != frozen_delta_.end() && !(rhs_key < frozen_iter->first));
+      bool has_delta = (delta_iter != delta_.end() && !(rhs_key < delta_iter->first));
+
+      if (!has_frozen && !has_delta) { break; }
+
+      const DeltaEntry *frozen_entry = nullptr;
+      const DeltaEntry *delta_entry = nullptr;
+      KeyT key;
+
+      if (has_frozen && (!has_delta || !(delta_iter->first < frozen_iter->first))) {
+        key = frozen_iter->first;
+        frozen_entry = &(frozen_iter->second);
+        ++frozen_iter;
+      } else {
+        key = delta_iter->first;
+      }
+      if (has_delta && !(key < delta_iter->first)) {
+        delta_entry = &(delta_iter->second);
+        ++delta_iter;
+      }
+
+      if (base_ != nullptr) {
+        if (!is_erased(frozen_entry, delta_entry)) {
+          base_->find_range(curr_key, key, offsets);
+        } else if (curr_key < key) {
+          base_->find_range(curr_key, key - 1, offsets);
+        }
+      }
+      copy_delta_offsets(frozen_entry, delta_entry, offsets);
+
+      if (key == rhs_key) { return; }
+      curr_key = key + 1;
+    }
+
+    if (base_ != nullptr) {
+      base_->find_range(curr_key, rhs_key, offsets);
+    }
+  }
+
+  virtual void scan(const KeyT &key, std::vector<Uint64> &offsets) final {
+    find(key, offsets);
+  }
+
+  virtual void scan_reverse(const KeyT &key, std::vector<Uint64> &offsets) final {
+    size_t begin_pos = offsets.size();
+    find(key, offsets);
+    std::reverse(offsets.begin() + begin_pos, offsets.end());
+  }
+
+  virtual void scan_full(std::vector<Uint64> &offsets, const size_t count) final {
+    size_t begin_pos = offsets.size();
+    find_range(std::numeric_limits<KeyT>::min(), std::numeric_limits<KeyT>::max(), offsets);
+    if (offsets.size() - begin_pos > count) {
+      offsets.resize(begin_pos + count);
+    }
+  }
+
+  virtual size_t size() const final {
+    ReadGuard guard(lock_);
+
+    return size_;
+  }
+
+  // merge all updates into the base, and wait until the merge is done.
+  virtual void reorganize() final {
+    WriteGuard guard(lock_);
+
+    install_merged_base(true);
+
+    if (!delta_.empty() && can_merge()) {
+      frozen_delta_.swap(delta_);
+      update_count_ = 0;
+
+      merged_base_ = merge(base_, frozen_delta_);
+      is_merge_done_ = true;
+      install_merged_base(true);
+    }
+  }
+
+  // static indexes built by merges use up to thread_count threads.
+  virtual void prepare_threads(const size_t thread_count) final {
+    thread_count_ = std::max(thread_count, (size_t)1);
+  }
+
+  virtual void register_thread(const size_t thread_id) final {}
+
+  virtual void print() const final {
+    ReadGuard guard(lock_);
+
+    std::cout << "merge threshold = " << merge_threshold_ << std::endl;
+    std::cout << "minimum merge size = " << min_size_ << std::endl;
+    std::cout << "number of merges = " << merge_count_ << std::endl;
+    std::cout << "number of updated keys = " << delta_.size() + frozen_delta_.size() << std::endl;
+    if (base_ != nullptr) {
+      base_->print();
+    }
+  }
+
+  // static indexes built by merges back their arrays with the given allocation type.
+  void set_allocation_type(const StaticAllocationType allocation_type) {
+    allocation_type_ = allocation_type;
+  }
+
+private:
+
+  struct ReadGuard {
+    ReadGuard(pthread_rwlock_t &lock) : lock_(lock) { pthread_rwlock_rdlock(&lock_); }
+    ~ReadGuard() { pthread_rwlock_unlock(&lock_); }
+
+    pthread_rwlock_t &lock_;
+  };
+
+  struct WriteGuard {
+    WriteGuard(pthread_rwlock_t &lock) : lock_(lock) { pthread_rwlock_wrlock(&lock_); }
+    ~WriteGuard() { pthread_rwlock_unlock(&lock_); }
+
+    pthread_rwlock_t &lock_;
+  };
+
+  // find without taking the lock.
+  void find_entries(const KeyT &key, std::vector<Uint64> &offsets) const {
+
+    const DeltaEntry *frozen_entry = find_entry(frozen_delta_, key);
+    const DeltaEntry *delta_entry = find_entry(delta_, key);
+
+    if (base_ != nullptr && !is_erased(frozen_entry, delta_entry)) {
+      base_->find(key, offsets);
+    }
+    copy_delta_offsets(frozen_entry, delta_entry, offsets);
+  }
+
+  static const DeltaEntry* find_entry(const DeltaMap &delta, const KeyT &key) {
+    auto iter = delta.find(key);
+    if (iter == delta.end()) {
+      return nullptr;
+    }
+    return &(iter->second);
+  }
+
+  // whether entries of a key in the base are erased by the frozen delta or the delta.
+  static bool is_erased(const DeltaEntry *frozen_entry, const DeltaEntry *delta_entry) {
+    return (frozen_entry != nullptr && frozen_entry->erased_) || (delta_entry != nullptr && delta_entry->erased_);
+  }
+
+  static void copy_delta_offsets(const DeltaEntry *frozen_entry, const DeltaEntry *delta_entry, std::vector<Uint64> &offsets) {
+    // an erase in the delta also hides offsets inserted into the frozen delta
+    if (frozen_entry != nullptr && !(delta_entry != nullptr && delta_entry->erased_)) {
+      offsets.insert(offsets.end(), frozen_entry->offsets_.begin(), frozen_entry->offsets_.end());
+    }
+    if (delta_entry != nullptr) {
+      offsets.insert(offsets.end(), delta_entry->offsets_.begin(), delta_entry->offsets_.end());
+    }
+  }
+
+  // no merge is pending when this is called, so a merge would build
+  // a static index on all size_ entries, or none.
+  bool can_merge() const {
+    return size_ == 0 || size_ >= min_size_;
+  }
+
+  // start a background merge once the delta is large enough.
+  // if a merge is still running, or the index holds too few entries, the delta
+  // keeps growing until the merge can start.
+  void count_update() {
+    ++update_count_;
+
+    if (update_count_ < merge_threshold_ || merge_thread_.joinable() || !can_merge()) {
+      return;
+    }
+
+    frozen_delta_.swap(delta_);
+    update_count_ = 0;
+
+    merge_thread_ = std::thread([this]() {
+      merged_base_ = merge(base_, frozen_delta_);
+      is_merge_done_.store(true, std::memory_order_release);
+    });
+  }
+
+  // replace the base by the result of a merge, if the merge is done.
+  // with wait set, wait for a running merge.
+  void install_merged_base(const bool wait) {
+    if (!merge_thread_.joinable() && !is_merge_done_.load(std::memory_order_acquire)) {
+      return;
+    }
+    if (!wait && !is_merge_done_.load(std::memory_order_acquire)) {
+      return;
+    }
+    if (merge_thread_.joinable()) {
+      merge_thread_.join();
+    }
+
+    delete base_;
+    base_ = merged_base_;
+    merged_base_ = nullptr;
+
+    frozen_delta_.clear();
+    is_merge_done_ = false;
+    ++merge_count_;
+  }
+
+  // build a static index holding the entries of base after applying the updates of delta.
+  // return nullptr if no entry is left.
+  StaticIndexT* merge(const StaticIndexT *base, const DeltaMap &delta) const {
+
+    std::vector<std::pair<KeyT, Uint64>> entries;
+
+    size_t base_size = (base != nullptr) ? base->size() : 0;
+    entries.reserve(base_size + delta.size());
+
+    size_t pos = 0;
+    for (auto &delta_entry : delta) {
+      const KeyT &key = delta_entry.first;
+
+      while (pos < base_size && base->get_key(pos) < key) {
+        entries.emplace_back(base->get_key(pos), base->offset_at(pos));
+        ++pos;
+      }
+      while (pos < base_size && base->get_key(pos) == key) {
+        if (!delta_entry.second.erased_) {
+          entries.emplace_back(key, base->offset_at(pos));
+        }
+        ++pos;
+      }
+      for (auto offset : delta_entry.second.offsets_) {
+        entries.emplace_back(key, offset);
+      }
+    }
+    while (pos < base_size) {
+      entries.emplace_back(base->get_key(pos), base->offset_at(pos));
+      ++pos;
+    }
+
+    if (entries.empty()) {
+      return nullptr;
+    }
+
+    StaticIndexT *index = factory_();
+    index->prepare_threads(thread_count_);
+    index->set_allocation_type(allocation_type_);
+
+    index->set_source_entries(&entries);
+    index->reorganize();
+    index->set_source_entries(nullptr);
+
+    return index;
+  }
+
+private:
+
+  // creates empty static indexes to hold merged entries
+  StaticIndexFactory factory_;
+
+  // number of updates absorbed by the delta before it is merged
+  size_t merge_threshold_;
+
+  // smallest number of entries the wrapped index can be built on
+  size_t min_size_;
+
+  // static index holding entries up to the last installed merge
+  StaticIndexT *base_;
+
+  // updates being merged into merged_base_ by merge_thread_
+  DeltaMap frozen_delta_;
+  StaticIndexT *merged_base_;
+  std::thread merge_thread_;
+  std::atomic<bool> is_merge_done_;
+
+  // updates since frozen_delta_ was frozen
+  DeltaMap delta_;
+  size_t update_count_;
+
+  size_t merge_count_;
+
+  size_t size_;
+
+  size_t thread_count_;
+
+  StaticAllocationType allocation_type_;
+
+  // shared by lookups, held exclusively by updates
+  mutable pthread_rwlock_t lock_;
+
+};
+
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <vector>
+
+#include "base_static_index.h"
+
+namespace static_index {
+
+// keys are laid out in Eytzinger (BFS) order: the children of node k are nodes 2k and 2k + 1.
+// node 0 is unused, so that the 2^i descendants of node k that are i levels below it
+// are stored contiguously starting from node k * 2^i.
+template<typename KeyT, typename ValueT>
+class EytzingerIndex : public BaseStaticIndex<KeyT, ValueT> {
+
+  // number of keys in a cacheline.
+  // prefetching node k * PREFETCH_STRIDE fetches all the descendants of node k
+  // that are log2(PREFETCH_STRIDE) levels below it.
+  static const size_t PREFETCH_STRIDE = BaseStaticIndex<KeyT, ValueT>::CACHELINE_SIZE / sizeof(KeyT);
+
+public:
+  EytzingerIndex(DataTable<KeyT, ValueT> *table_ptr, const StaticLayoutType layout_type = StaticLayoutType::AoSLayoutType) :
+    BaseStaticIndex<KeyT, ValueT>(table_ptr, layout_type),
+    inner_nodes_(nullptr),
+    tree_height_(0),
+    last_layer_count_(0) {}
+
+  virtual ~EytzingerIndex() {
+    this->free_array(inner_nodes_);
+    inner_nodes_ = nullptr;
+  }
+
+  virtual void find(const KeyT &key, std::vector<Uint64> &offsets) final {
+
+    if (this->size_ == 0) {
+      return;
+    }
+
+    if (key > key_max_ || key < key_min_) {
+      return;
+    }
+
+    // the first entry matching key is the lower bound of key
+    size_t offset_find = find_bound(key, false);
+
+    while (offset_find < this->size_ && this->key_at(offset_find) == key) {
+      offsets.push_back(this->offset_at(offset_find));
+      ++offset_find;
+    }
+  }
+
+  virtual void find_range(const KeyT &lhs_key, const KeyT &rhs_key, std::vector<Uint64> &offsets) final {
+
+    if (lhs_key > rhs_key) { return; }
+
+    if (this->size_ == 0) {
+      return;
+    }
+    if (lhs_key > key_max_ || rhs_key < key_min_) {
+      return;
+    }
+
+    size_t lhs_offset = find_bound(lhs_key, false);
+    size_t rhs_offset = find_bound(rhs_key, true);
+
+    this->base_copy_offsets(lhs_offset, rhs_offset, offsets);
+  }
+
+  virtual void reorganize() final {
+
+    this->base_reorganize();
+
+    if (this->size_ == 0) {
+      return;
+    }
+
+    key_min_ = this->key_at(0);
+    key_max_ = this->key_at(this->size_ - 1);
+
+    tree_height_ = 0;
+    while ((1ull << tree_height_) - 1 < this->size_) {
+      ++tree_height_;
+    }
+    last_layer_count_ = this->size_ - ((1ull << (tree_height_ - 1)) - 1);
+
+    inner_nodes_ = this->template allocate_array<KeyT>(this->size_ + 1);
+    memset(inner_nodes_, 0, sizeof(KeyT) * (this->size_ + 1));
+
+    this->parallel_for(this->size_, this->PARALLEL_GRAIN_SIZE, [&](const size_t begin_pos, const size_t end_pos) {
+      for (size_t k = begin_pos + 1; k <= end_pos; ++k) {
+        inner_nodes_[k] = this->key_at(node_to_offset(k));
+      }
+    });
+  }
+
+  virtual void print() const final {
+    if (inner_nodes_ != nullptr) {
+      for (size_t k = 1; k <= this->size_; ++k) {
+        std::cout << inner_nodes_[k] << " ";
+      }
+      std::cout << std::endl;
+    }
+  }
+
+private:
+
+  // return the first offset whose key is no less than key,
+  // or larger than key if is_upper is true.
+  virtual size_t find_bound(const KeyT &key, const bool is_upper) final {
+
+    size_t k = 1;
+    if (is_upper == false) {
+      while (k <= this->size_) {
+        __builtin_prefetch(inner_nodes_ + k * PREFETCH_STRIDE);
+        k = 2 * k + (inner_nodes_[k] < key);
+      }
+    } else {
+      while (k <= this->size_) {
+        __builtin_prefetch(inner_nodes_ + k * PREFETCH_STRIDE);
+        k = 2 * k + !(key < inner_nodes_[k]);
+      }
+    }
+
+    // the path ends with a left turn into the bound followed by right turns only.
+    // cancel these right turns and the final left turn.
+    k >>= __builtin_ffsll(~k);
+
+    if (k == 0) {
+      // all keys precede the bound
+      return this->size_;
+    }
+    return node_to_offset(k);
+  }
+
+  // map node k to its in-order rank, which is its offset in the sorted entries.
+  size_t node_to_offset(const size_t k) const {
+    size_t depth = 63 - __builtin_clzll(k);
+    size_t pos = k - (1ull << depth);
+
+    // rank of node k if the last layer were full
+    size_t full_rank = ((2 * pos + 1) << (tree_height_ - depth - 1)) - 1;
+
+    // the full last layer holds every other rank (0, 2, 4, ...),
+    // but only its first last_layer_count_ nodes exist.
+    size_t last_layer_before = (full_rank + 1) / 2;
+    if (last_layer_before > last_layer_count_) {
+      return full_rank - (last_layer_before - last_layer_count_);
+    }
+    return full_rank;
+  }
+
+private:
+
+  KeyT key_min_;
+  KeyT key_max_;
+
+  // there are size_ + 1 nodes in total. node 0 is unused.
+  KeyT *inner_nodes_;
+
+  size_t tree_height_;
+  size_t last_layer_count_;
+
+};
+
+}
@@ -1,45 +1,63 @@
 #pragma once
 
 #include <vector>
+#include <type_traits>
 
 #include <emmintrin.h>
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
 
 #include "base_static_index.h"
 
 namespace static_index {
 
+// FAST: Fast Architecture Sensitive Tree.
+// separators are organized in a hierarchy of blocks:
+//   - a simd block holds a 2-level subtree of 3 keys, compared at once;
+//   - a cacheline block holds a 4-level subtree made of 5 simd blocks (16 key slots);
+//   - a page block holds a subtree of cacheline blocks that fits in a page.
+// with 8-byte keys, a cacheline block spans two adjacent cachelines.
+// if the compiler targets AVX2 or AVX-512, all the keys of a cacheline block
+// are compared with independent wide loads instead of two dependent simd blocks.
+// simd instructions only compare signed integers, so separators are stored with
+// their sign bits flipped, and so are search keys before descending the tree.
 template<typename KeyT, typename ValueT>
 class FastIndex : public BaseStaticIndex<KeyT, ValueT> {
 
-  // the FAST index paper assumes SIMD size is 128 bits.
-  // It is hard to extend its method to 256/512-bit SIMD
-  // as most computers' cacheline size is 64 bytes.
-  const size_t SIMD_SIZE = 16; // unit: byte (128 bits)
-  const size_t CACHELINE_SIZE = 64; // unit: byte
-  const size_t PAGE_SIZE = 4096; // unit: byte (4 KB)
+  static const size_t PAGE_SIZE = 4096; // unit: byte (4 KB)
 
-  const size_t KEY_SIZE = 4; // FAST only support 4-byte keys.
-  const size_t SIMD_KEY_CAPACITY = 3; 
-  const size_t CACHELINE_KEY_CAPACITY = 15;
-  const size_t CACHELINE_DEPTH = 4;
+  static const size_t SIMD_KEY_CAPACITY = 3;
+  static const size_t CACHELINE_KEY_CAPACITY = 15;
+  static const size_t CACHELINE_DEPTH = 4;
+  static const size_t CACHELINE_FANOUT = 16;
 
+  // slots of a cacheline block. the last slot is padding.
+  static const size_t BLOCK_KEY_SLOTS = 16;
 
-public:
-  FastIndex(DataTable<KeyT, ValueT> *table_ptr, const size_t num_layers)
-    : BaseStaticIndex<KeyT, ValueT>(table_ptr)
-    , num_layers_(num_layers) {
+  typedef std::integral_constant<size_t, sizeof(KeyT)> KeySizeTag;
+  typedef typename std::make_signed<KeyT>::type SignedKeyT;
+
+  static const KeyT SIGN_BIT = KeyT(1) << (sizeof(KeyT) * 8 - 1);
 
-    ASSERT(sizeof(KeyT) == KEY_SIZE, "only support 4-byte keys");
+public:
+  FastIndex(DataTable<KeyT, ValueT> *table_ptr, const size_t num_layers, const StaticLayoutType layout_type = StaticLayoutType::AoSLayoutType)
+    : BaseStaticIndex<KeyT, ValueT>(table_ptr, layout_type)
+    , num_layers_(num_layers)
+    , inner_nodes_(nullptr)
+    , inner_size_(0)
+    , cacheline_levels_(0)
+    , page_levels_(0) {
+
+    ASSERT(sizeof(KeyT) == 4 || sizeof(KeyT) == 8, "only support 4-byte and 8-byte keys");
   }
 
   virtual ~FastIndex() {
-    if (num_layers_ != 0) {
-      delete[] inner_nodes_;
-      inner_nodes_ = nullptr;
-
-      delete num_cachelines_;
-      num_cachelines_ = nullptr;
-    }
+    this->free_array(inner_nodes_);
+    inner_nodes_ = nullptr;
   }
 
   virtual void find(const KeyT &key, std::vector<Uint64> &offsets) final {
@@ -54,53 +72,50 @@ public:
     if (key_max_ == key_min_) {
       if (key_max_ == key) {
         for (size_t i = 0; i < this->size_; ++i) {
-          offsets.push_back(this->container_[i].offset_);
+          offsets.push_back(this->offset_at(i));
         }
       }
       return;
     }
 
-    size_t offset_find = this->size_;
-    std::pair<int, int> offset_range = find_inner_layers(key);
-    if (offset_range.first == offset_range.second) {
-      offset_find = offset_range.first;
-    } else {
-      offset_find = find_internal(key, offset_range.first, offset_range.second);
+    // the first entry matching key is the lower bound of key
+    size_t offset_find = find_lower_bound(key);
+
+    while (offset_find < this->size_ && this->key_at(offset_find) == key) {
+      offsets.push_back(this->offset_at(offset_find));
+      ++offset_find;
     }
+  }
+
+  // inner layers are small and stay cached, so each lookup descends them on its own.
+  // the searches over the sorted entries, which miss the cache, are then interleaved.
+  virtual void find_batch(const KeyT *keys, const size_t count, std::vector<Uint64> *offsets) final {
 
-    if (offset_find == this->size_) {
-      // find nothing
+    if (this->size_ == 0) {
       return;
     }
 
-    offsets.push_back(this->container_[offset_find].offset_);
-
-    // move left
-    int offset_find_lhs = offset_find - 1;
-    while (offset_find_lhs >= 0) {
+    std::vector<size_t> begin_offsets(count);
+    std::vector<size_t> end_offsets(count);
 
-      if (this->container_[offset_find_lhs].key_ == key) {
-        offsets.push_back(this->container_[offset_find_lhs].offset_);
-        offset_find_lhs -= 1;
-      } else {
-        break;
-      }
-    }
-    // move right
-    int offset_find_rhs = offset_find + 1;
-    while (offset_find_rhs <= this->size_ - 1) {
-
-      if (this->container_[offset_find_rhs].key_ == key) {
-        offsets.push_back(this->container_[offset_find_rhs].offset_);
-        offset_find_rhs += 1;
-      } else {
-        break;
+    for (size_t i = 0; i < count; ++i) {
+      if (keys[i] > key_max_ || keys[i] < key_min_ || key_max_ == key_min_) {
+        // the lower bound is the first entry, which matches only if all keys are equal
+        begin_offsets[i] = 0;
+        end_offsets[i] = 0;
+        continue;
       }
+      std::pair<int64_t, int64_t> offset_range = find_inner_layers(keys[i], false);
+      begin_offsets[i] = offset_range.first;
+      end_offsets[i] = offset_range.second + 1;
     }
+
+    this->base_find_batch(keys, count, begin_offsets.data(), end_offsets.data(), offsets);
   }
 
   virtual void find_range(const KeyT &lhs_key, const KeyT &rhs_key, std::vector<Uint64> &offsets) final {
-    assert(lhs_key < rhs_key);
+
+    if (lhs_key > rhs_key) { return; }
 
     if (this->size_ == 0) {
       return;
@@ -109,6 +124,15 @@ public:
       return;
     }
 
+    size_t lhs_offset = find_lower_bound(lhs_key);
+    size_t rhs_offset = find_upper_bound(rhs_key);
+
+    this->base_copy_offsets(lhs_offset, rhs_offset, offsets);
+  }
+
+  // the inner layers need fewer nodes than entries
+  virtual size_t get_min_size() const final {
+    return (size_t)1 << num_layers_;
   }
 
   virtual void reorganize() final {
@@ -120,24 +144,22 @@ public:
     ASSERT(inner_node_size < this->size_, "exceed maximum layers");
 
     cacheline_levels_ = num_layers_ / CACHELINE_DEPTH;
-    num_cachelines_ = new size_t[cacheline_levels_ + 1];
-    for (size_t i = 0; i < cacheline_levels_ + 1; ++i) {
-      num_cachelines_[i] = std::pow(16, i);
-    }
-    
+
+    size_t num_leaf_ranges = 1ull << (CACHELINE_DEPTH * cacheline_levels_);
+
     lhs_offset_ = 0;
-    rhs_offset_ = this->size_ - 1 - this->size_ % num_cachelines_[cacheline_levels_];
+    rhs_offset_ = this->size_ - 1 - this->size_ % num_leaf_ranges;
 
-    last_level_step_ = (rhs_offset_ - lhs_offset_ + 1) / num_cachelines_[cacheline_levels_];
+    last_level_step_ = (rhs_offset_ - lhs_offset_ + 1) / num_leaf_ranges;
 
-    key_min_ = this->container_[0].key_;
-    key_max_ = this->container_[this->size_ - 1].key_;
+    key_min_ = this->key_at(0);
+    key_max_ = this->key_at(this->size_ - 1);
 
-    if (num_layers_ != 0) {
+    if (cacheline_levels_ != 0) {
 
-      size_t num_cachelines = inner_node_size / CACHELINE_KEY_CAPACITY;
-      inner_size_ = num_cachelines * CACHELINE_SIZE / sizeof(KeyT);
-      inner_nodes_ = new KeyT[inner_size_];
+      size_t num_blocks = construct_page_layout();
+      inner_size_ = num_blocks * BLOCK_KEY_SLOTS;
+      inner_nodes_ = this->template allocate_array<KeyT>(inner_size_, PAGE_SIZE);
       memset(inner_nodes_, 0, sizeof(KeyT) * inner_size_);
 
       construct_inner_layers();
@@ -149,7 +171,7 @@ public:
   virtual void print() const final {
     if (inner_nodes_ != nullptr) {
       for (size_t i = 0; i < inner_size_; ++i) {
-        std::cout << inner_nodes_[i] << " ";
+        std::cout << flip_sign(inner_nodes_[i]) << " ";
       }
       std::cout << std::endl;
     }
@@ -157,26 +179,75 @@ public:
 
 private:
 
-  void construct_inner_layers() {
-    ASSERT(num_layers_ != 0, "number of layers cannot be 0");
+  // group cacheline levels into page blocks.
+  // page levels are stored one after another. a page level is an array of
+  // page blocks, and each page block stores its cacheline blocks level by level.
+  // inner nodes are page-aligned, page levels start at page boundaries, and page
+  // blocks are padded to a power of two, so that no page block straddles two pages.
+  // return the total number of cacheline blocks, including padding.
+  size_t construct_page_layout() {
+
+    size_t block_size = BLOCK_KEY_SLOTS * sizeof(KeyT);
+    size_t page_block_capacity = PAGE_SIZE / block_size;
+
+    // number of cacheline levels in a full page block
+    page_levels_ = 1;
+    while (subtree_block_count(page_levels_ + 1) <= page_block_capacity) {
+      ++page_levels_;
+    }
 
-    // cacheline level 0
-    size_t current_pos = 0;
-    construct_cacheline_block(current_pos, lhs_offset_, rhs_offset_);
-    current_pos += 16; // cacheline size
+    level_bases_.assign(cacheline_levels_, 0);
+    level_strides_.assign(cacheline_levels_, 0);
+    level_shifts_.assign(cacheline_levels_, 0);
 
-    // cacheline level i
-    for (size_t i = 1; i < cacheline_levels_; ++i) {
-      size_t num_cachelines = std::pow(16, i);
-      size_t step = (rhs_offset_ - lhs_offset_ + 1) / num_cachelines;
+    size_t page_level_base = 0;
+    for (size_t i = 0; i < cacheline_levels_; i += page_levels_) {
+      size_t page_depth = std::min(page_levels_, cacheline_levels_ - i);
+      size_t page_block_stride = 1;
+      while (page_block_stride < subtree_block_count(page_depth)) {
+        page_block_stride <<= 1;
+      }
+      size_t page_block_count = 1ull << (CACHELINE_DEPTH * i);
 
-      for (size_t j = 0; j < num_cachelines; ++j) {
-        construct_cacheline_block(current_pos, step * j, step * (j + 1) - 1);
-        current_pos += 16;
+      for (size_t l = 0; l < page_depth; ++l) {
+        level_bases_[i + l] = page_level_base + subtree_block_count(l);
+        level_strides_[i + l] = page_block_stride;
+        level_shifts_[i + l] = CACHELINE_DEPTH * l;
       }
+      page_level_base += page_block_count * page_block_stride;
+      page_level_base = (page_level_base + page_block_capacity - 1) / page_block_capacity * page_block_capacity;
     }
+    return page_level_base;
   }
- 
+
+  // number of cacheline blocks in a subtree of the given number of cacheline levels.
+  size_t subtree_block_count(const size_t levels) const {
+    return ((1ull << (CACHELINE_DEPTH * levels)) - 1) / (CACHELINE_FANOUT - 1);
+  }
+
+  // position of the block_id-th cacheline block in cacheline level i. unit: key slot.
+  size_t block_position(const size_t i, const size_t block_id) const {
+    size_t page_block_id = block_id >> level_shifts_[i];
+    size_t local_block_id = block_id & ((1ull << level_shifts_[i]) - 1);
+    return (level_bases_[i] + page_block_id * level_strides_[i] + local_block_id) * BLOCK_KEY_SLOTS;
+  }
+
+  // cacheline blocks in a level cover disjoint ranges, so they are built in parallel.
+  void construct_inner_layers() {
+    ASSERT(cacheline_levels_ != 0, "number of cacheline levels cannot be 0");
+
+    for (size_t i = 0; i < cacheline_levels_; ++i) {
+      size_t num_blocks = 1ull << (CACHELINE_DEPTH * i);
+      size_t step = (rhs_offset_ - lhs_offset_ + 1) / num_blocks;
+
+      this->parallel_for(num_blocks, this->PARALLEL_GRAIN_SIZE / BLOCK_KEY_SLOTS, [&](const size_t begin_block, const size_t end_block) {
+        for (size_t j = begin_block; j < end_block; ++j) {
+          construct_cacheline_block(block_position(i, j), lhs_offset_ + step * j, lhs_offset_ + step * (j + 1) - 1);
+        }
+      });
+    }
+  }
+
   // we only support the case for simd key capacity = 3.
   // in this case, the number of simd blocks in each cacheline block is 5.
   void construct_cacheline_block(const size_t current_pos, const size_t lhs_offset, const size_t rhs_offset) {
@@ -187,7 +258,7 @@ private:
     // simd level 1
     size_t step = (rhs_offset - lhs_offset + 1) / 4;
     for (size_t i = 0; i < 4; ++i) {
-      construct_simd_block(current_pos + 3 * (i + 1), lhs_offset + step * i, lhs_offset + step * (i + 1) - 1);
+      construct_simd_block(current_pos + SIMD_KEY_CAPACITY * (i + 1), lhs_offset + step * i, lhs_offset + step * (i + 1) - 1);
     }
   }
 
@@ -196,91 +267,223 @@ private:
 
     size_t step = (rhs_offset - lhs_offset + 1) / 4;
 
-    inner_nodes_[current_pos + 0] = this->container_[lhs_offset + 2 * step - 1].key_;
-    inner_nodes_[current_pos + 1] = this->container_[lhs_offset + 1 * step - 1].key_;
-    inner_nodes_[current_pos + 2] = this->container_[lhs_offset + 3 * step - 1].key_;
+    inner_nodes_[current_pos + 0] = flip_sign(this->key_at(lhs_offset + 2 * step - 1));
+    inner_nodes_[current_pos + 1] = flip_sign(this->key_at(lhs_offset + 1 * step - 1));
+    inner_nodes_[current_pos + 2] = flip_sign(this->key_at(lhs_offset + 3 * step - 1));
 
   }
 
-  // find in inner nodes
-  std::pair<int, int> find_inner_layers(const KeyT &key) {
-
-    if (num_layers_ == 0) { return std::pair<int, int>(0, this->size_ - 1); }
-
-    // cacheline level 0
-    size_t current_pos = 0;
-    size_t branch_id = lookup_cacheline_block(key, current_pos);
-    current_pos += 16; // beginning position in next level
-    
-    size_t num_cachelines = std::pow(16, 1); // number of cachelines in next level
-    
-    for (size_t i = 1; i < cacheline_levels_; ++i) {
-      
-      size_t new_branch_id = lookup_cacheline_block(key, current_pos + branch_id * 16);
-      
-      branch_id = branch_id * 16 + new_branch_id;
-      current_pos += 16 * num_cachelines; // beginning position in next level
-
-      num_cachelines = std::pow(16, (i + 1)); // number of cachelines in next level
+  // map unsigned order to signed order.
+  KeyT flip_sign(const KeyT key) const {
+    return key ^ SIGN_BIT;
+  }
+
+  virtual size_t find_bound(const KeyT &key, const bool is_upper) final {
+    return is_upper ? find_upper_bound(key) : find_lower_bound(key);
+  }
+
+  // return the first offset whose key is no less than key.
+  size_t find_lower_bound(const KeyT &key) {
+    std::pair<int64_t, int64_t> offset_range = find_inner_layers(key, false);
+    return this->base_lower_bound(key, offset_range.first, offset_range.second + 1);
+  }
+
+  // return the first offset whose key is larger than key.
+  size_t find_upper_bound(const KeyT &key) {
+    std::pair<int64_t, int64_t> offset_range = find_inner_layers(key, true);
+    return this->base_upper_bound(key, offset_range.first, offset_range.second + 1);
+  }
+
+  // find in inner nodes.
+  // each branch covers the keys in (previous separator, next separator],
+  // so the lower bound of key lies in the returned range or right after it.
+  // if is_upper is true, the same holds for the upper bound of key.
+  std::pair<int64_t, int64_t> find_inner_layers(const KeyT &key, const bool is_upper = false) {
+
+    if (cacheline_levels_ == 0) { return std::pair<int64_t, int64_t>(0, this->size_ - 1); }
+
+    KeyT flipped_key = flip_sign(key);
+
+    size_t branch_id = 0;
+    for (size_t i = 0; i < cacheline_levels_; ++i) {
+      size_t new_branch_id = lookup_cacheline_block(flipped_key, block_position(i, branch_id), is_upper);
+      branch_id = branch_id * CACHELINE_FANOUT + new_branch_id;
     }
-    
-    if (branch_id < num_cachelines - 1) {
 
-      return std::pair<int, int>(branch_id * last_level_step_, (branch_id + 1) * last_level_step_ - 1);
+    size_t num_leaf_ranges = 1ull << (CACHELINE_DEPTH * cacheline_levels_);
+
+    if (branch_id < num_leaf_ranges - 1) {
+
+      return std::pair<int64_t, int64_t>(branch_id * last_level_step_, (branch_id + 1) * last_level_step_ - 1);
     } else {
 
-      return std::pair<int, int>(branch_id * last_level_step_, this->size_ - 1);
+      return std::pair<int64_t, int64_t>(branch_id * last_level_step_, this->size_ - 1);
     }
-    
+
   }
 
-  // search in cacheline block
-  size_t lookup_cacheline_block(const KeyT &key, const size_t current_pos) {
+  // search in cacheline block.
+  // key and separators have their sign bits flipped and are compared as signed integers.
+  size_t lookup_cacheline_block(const KeyT &key, const size_t current_pos, const bool is_upper) const {
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+
+    unsigned mask = cacheline_block_mask(key, inner_nodes_ + current_pos, is_upper, KeySizeTag());
+
+    size_t branch_id = branch_table_[mask & 7];
+
+    size_t new_branch_id = branch_table_[(mask >> (SIMD_KEY_CAPACITY * (branch_id + 1))) & 7];
+
+#else
 
-    size_t branch_id = lookup_simd_block(key, current_pos);
-    
-    size_t new_pos = current_pos + 3 * (branch_id + 1);
+    size_t branch_id = branch_table_[simd_block_mask(key, inner_nodes_ + current_pos, is_upper, KeySizeTag()) & 7];
 
-    size_t new_branch_id = lookup_simd_block(key, new_pos); 
+    size_t new_pos = current_pos + SIMD_KEY_CAPACITY * (branch_id + 1);
+
+    size_t new_branch_id = branch_table_[simd_block_mask(key, inner_nodes_ + new_pos, is_upper, KeySizeTag()) & 7];
+
+#endif
 
     return branch_id * 4 + new_branch_id;
   }
 
-  // search in simd block
-  size_t lookup_simd_block(const KeyT &key, const size_t current_pos) {
+  // compare key with the 4 slots starting at block.
+  // bit i is set if slot i is smaller than key, or no larger than key if is_upper is true.
+  // only the lowest 3 bits belong to the simd block.
+  unsigned simd_block_mask(const KeyT &key, const KeyT *block, const bool is_upper, std::integral_constant<size_t, 4>) const {
 
     __m128i xmm_key_q =_mm_set1_epi32(key);
-    __m128i xmm_tree = _mm_loadu_si128((__m128i*)(inner_nodes_ + current_pos));
-    __m128i xmm_mask = _mm_cmpgt_epi32(xmm_key_q, xmm_tree);
-    unsigned index = _mm_movemask_ps(_mm_castsi128_ps(xmm_mask));
+    __m128i xmm_tree = _mm_loadu_si128((__m128i*)(block));
+    if (is_upper == false) {
+      __m128i xmm_mask = _mm_cmpgt_epi32(xmm_key_q, xmm_tree);
+      return _mm_movemask_ps(_mm_castsi128_ps(xmm_mask));
+    } else {
+      __m128i xmm_mask = _mm_cmpgt_epi32(xmm_tree, xmm_key_q);
+      return ~_mm_movemask_ps(_mm_castsi128_ps(xmm_mask));
+    }
+  }
+
+  unsigned simd_block_mask(const KeyT &key, const KeyT *block, const bool is_upper, std::integral_constant<size_t, 8>) const {
 
-    static unsigned table[8] = {0, 9, 1, 2, 9, 9, 9, 3}; // 9 stands for impossible
-    size_t branch_id = table[(index&7)];
+#if defined(__AVX2__)
 
-    return branch_id;
+    __m256i ymm_key_q = _mm256_set1_epi64x(key);
+    __m256i ymm_tree = _mm256_loadu_si256((__m256i*)(block));
+    if (is_upper == false) {
+      __m256i ymm_mask = _mm256_cmpgt_epi64(ymm_key_q, ymm_tree);
+      return _mm256_movemask_pd(_mm256_castsi256_pd(ymm_mask));
+    } else {
+      __m256i ymm_mask = _mm256_cmpgt_epi64(ymm_tree, ymm_key_q);
+      return ~_mm256_movemask_pd(_mm256_castsi256_pd(ymm_mask));
+    }
+
+#elif defined(__SSE4_2__)
+
+    // two keys per register
+    __m128i xmm_key_q = _mm_set1_epi64x(key);
+    __m128i xmm_tree_lo = _mm_loadu_si128((__m128i*)(block));
+    __m128i xmm_tree_hi = _mm_loadu_si128((__m128i*)(block + 2));
+    if (is_upper == false) {
+      unsigned mask_lo = _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(xmm_key_q, xmm_tree_lo)));
+      unsigned mask_hi = _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(xmm_key_q, xmm_tree_hi)));
+      return mask_lo | (mask_hi << 2);
+    } else {
+      unsigned mask_lo = _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(xmm_tree_lo, xmm_key_q)));
+      unsigned mask_hi = _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(xmm_tree_hi, xmm_key_q)));
+      return ~(mask_lo | (mask_hi << 2));
+    }
+
+#else
+
+    // no 64-bit simd comparison below SSE4.2
+    return scalar_block_mask(key, block, is_upper);
+
+#endif
   }
 
+  template<size_t KeySize>
+  unsigned simd_block_mask(const KeyT &key, const KeyT *block, const bool is_upper, std::integral_constant<size_t, KeySize>) const {
+    return scalar_block_mask(key, block, is_upper);
+  }
 
-  // last step
-  // find in leaf nodes, simple binary search [incl., incl.]
-  size_t find_internal(const KeyT &key, const int offset_begin, const int offset_end) {
-    if (offset_begin > offset_end) {
-      return this->size_;
+  unsigned scalar_block_mask(const KeyT &key, const KeyT *block, const bool is_upper) const {
+    unsigned mask = 0;
+    for (size_t i = 0; i < SIMD_KEY_CAPACITY; ++i) {
+      bool precedes = is_upper ? !((SignedKeyT)key < (SignedKeyT)block[i]) : (SignedKeyT)block[i] < (SignedKeyT)key;
+      mask |= (unsigned)precedes << i;
     }
-    int offset_lookup = (offset_begin + offset_end) / 2;
-    KeyT key_lookup = this->container_[offset_lookup].key_;
-    if (key == key_lookup) {
-      return offset_lookup;
+    return mask;
+  }
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+
+  // compare key with all the 16 slots of a cacheline block.
+  // bit i is set if slot i is smaller than key, or no larger than key if is_upper is true.
+  unsigned cacheline_block_mask(const KeyT &key, const KeyT *block, const bool is_upper, std::integral_constant<size_t, 4>) const {
+
+#if defined(__AVX512F__)
+
+    __m512i zmm_key_q = _mm512_set1_epi32(key);
+    __m512i zmm_tree = _mm512_loadu_si512((const void*)(block));
+    if (is_upper == false) {
+      return _mm512_cmpgt_epi32_mask(zmm_key_q, zmm_tree);
+    } else {
+      return _mm512_cmple_epi32_mask(zmm_tree, zmm_key_q);
+    }
+
+#else
+
+    __m256i ymm_key_q = _mm256_set1_epi32(key);
+    __m256i ymm_tree_lo = _mm256_loadu_si256((__m256i*)(block));
+    __m256i ymm_tree_hi = _mm256_loadu_si256((__m256i*)(block + 8));
+    if (is_upper == false) {
+      unsigned mask_lo = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(ymm_key_q, ymm_tree_lo)));
+      unsigned mask_hi = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(ymm_key_q, ymm_tree_hi)));
+      return mask_lo | (mask_hi << 8);
+    } else {
+      unsigned mask_lo = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(ymm_tree_lo, ymm_key_q)));
+      unsigned mask_hi = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(ymm_tree_hi, ymm_key_q)));
+      return ~(mask_lo | (mask_hi << 8));
     }
-    if (key > key_lookup) {
-      return find_internal(key, offset_lookup + 1, offset_end);
+
+#endif
+  }
+
+#if defined(__AVX512F__)
+
+  unsigned cacheline_block_mask(const KeyT &key, const KeyT *block, const bool is_upper, std::integral_constant<size_t, 8>) const {
+
+    __m512i zmm_key_q = _mm512_set1_epi64(key);
+    __m512i zmm_tree_lo = _mm512_loadu_si512((const void*)(block));
+    __m512i zmm_tree_hi = _mm512_loadu_si512((const void*)(block + 8));
+    if (is_upper == false) {
+      return _mm512_cmpgt_epi64_mask(zmm_key_q, zmm_tree_lo) | (_mm512_cmpgt_epi64_mask(zmm_key_q, zmm_tree_hi) << 8);
     } else {
-      return find_internal(key, offset_begin, offset_lookup - 1);
+      return _mm512_cmple_epi64_mask(zmm_tree_lo, zmm_key_q) | (_mm512_cmple_epi64_mask(zmm_tree_hi, zmm_key_q) << 8);
+    }
+  }
+
+#endif
+
+  // assemble the mask from the 4 simd blocks of slots.
+  template<size_t KeySize>
+  unsigned cacheline_block_mask(const KeyT &key, const KeyT *block, const bool is_upper, std::integral_constant<size_t, KeySize>) const {
+    unsigned mask = 0;
+    for (size_t i = 0; i < 4; ++i) {
+      mask |= (simd_block_mask(key, block + 4 * i, is_upper, KeySizeTag()) & 0xf) << (4 * i);
     }
+    return mask;
   }
 
+#endif
+
 private:
-  
+
+  // map the comparison mask of a simd block to its branch id,
+  // i.e., the number of separators that precede the bound.
+  // slot 0 holds the middle separator; 9 stands for impossible.
+  static const unsigned branch_table_[8];
+
   size_t num_layers_;
 
   KeyT key_min_;
@@ -292,9 +495,20 @@ private:
   size_t rhs_offset_;
   size_t last_level_step_;
   size_t cacheline_levels_;
-  size_t *num_cachelines_;
 
+  // number of cacheline levels in a full page block
+  size_t page_levels_;
+
+  // per cacheline level: position of the first block in the first page block,
+  // distance between page blocks, and log2 of the blocks per page block in this level.
+  // unit: cacheline block.
+  std::vector<size_t> level_bases_;
+  std::vector<size_t> level_strides_;
+  std::vector<size_t> level_shifts_;
 
 };
 
-}
\ No newline at end of file
+template<typename KeyT, typename ValueT>
+const unsigned FastIndex<KeyT, ValueT>::branch_table_[8] = {0, 9, 1, 2, 9, 9, 9, 3};
+
+}
@@ -1,10 +1,30 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 
 #include "base_static_index.h"
 
+// how the interpolation index places segment boundaries.
+enum class SegmentationType {
+  // segments cover equal key ranges
+  EquiWidthSegmentationType = 0,
+  // segments hold equal numbers of entries
+  EquiDepthSegmentationType,
+};
+
+static std::string get_segmentation_name(const SegmentationType segmentation_type) {
+  if (segmentation_type == SegmentationType::EquiWidthSegmentationType) {
+    return "equi-width";
+  } else if (segmentation_type == SegmentationType::EquiDepthSegmentationType) {
+    return "equi-depth";
+  } else {
+    ASSERT(false, "invalid segmentation type");
+    return "";
+  }
+}
+
 namespace static_index {
 
 template<typename KeyT, typename ValueT>
@@ -12,6 +32,20 @@ class InterpolationIndex : public BaseStaticIndex<KeyT, ValueT> {
 
   struct Stats {
 
+    // bound searches are counted by every lookup thread. threads count into their own
+    // cachelines, which print() adds up. threads sharing a slot may lose counts.
+    static const size_t SEARCH_COUNTER_SLOT_COUNT = 64;
+
+    static const size_t CACHELINE_SIZE = 64; // unit: byte
+
+    struct SearchCounter {
+      SearchCounter() : search_count_(0), search_probe_count_(0) {}
+
+      std::atomic<uint64_t> search_count_;
+      std::atomic<uint64_t> search_probe_count_;
+      char padding_[CACHELINE_SIZE - 2 * sizeof(std::atomic<uint64_t>)];
+    };
+
     Stats() : 
       is_first_match_(true), 
       find_op_count_(0), 
@@ -34,15 +68,39 @@ class InterpolationIndex : public BaseStaticIndex<KeyT, ValueT> {
       }
     }
 
+    // record number of keys probed by a bound search
+    void measure_search_probes(const size_t probes) {
+      SearchCounter &counter = search_counters_[get_thread_number() % SEARCH_COUNTER_SLOT_COUNT];
+      counter.search_count_.store(counter.search_count_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      counter.search_probe_count_.store(counter.search_probe_count_.load(std::memory_order_relaxed) + probes, std::memory_order_relaxed);
+    }
+
+    uint64_t get_search_count() const {
+      uint64_t count = 0;
+      for (size_t i = 0; i < SEARCH_COUNTER_SLOT_COUNT; ++i) {
+        count += search_counters_[i].search_count_.load(std::memory_order_relaxed);
+      }
+      return count;
+    }
+
+    uint64_t get_search_probe_count() const {
+      uint64_t count = 0;
+      for (size_t i = 0; i < SEARCH_COUNTER_SLOT_COUNT; ++i) {
+        count += search_counters_[i].search_probe_count_.load(std::memory_order_relaxed);
+      }
+      return count;
+    }
+
     bool is_first_match_;
     uint64_t find_op_count_;
     uint64_t find_op_profile_count_;
     uint64_t find_op_guess_distance_;
+    SearchCounter search_counters_[SEARCH_COUNTER_SLOT_COUNT];
   };
 
 public:
-  InterpolationIndex(DataTable<KeyT, ValueT> *table_ptr, const size_t num_segments = 1) 
-    : BaseStaticIndex<KeyT, ValueT>(table_ptr) {
+  InterpolationIndex(DataTable<KeyT, ValueT> *table_ptr, const size_t num_segments = 1, const StaticLayoutType layout_type = StaticLayoutType::AoSLayoutType, const SegmentationType segmentation_type = SegmentationType::EquiWidthSegmentationType) 
+    : BaseStaticIndex<KeyT, ValueT>(table_ptr, layout_type), segmentation_type_(segmentation_type) {
 
     ASSERT(num_segments >= 1, "must have at least one segment");
 
@@ -87,128 +145,48 @@ public:
     if (key_min_ == key_max_) {
       if (key_min_ == key) {
         for (size_t i = 0; i < this->size_; ++i) {
-          offsets.push_back(this->container_[i].offset_);
+          offsets.push_back(this->offset_at(i));
         }
       }
       return;
     }
 
-    // find suitable segment
-    size_t segment_id = (key - key_min_) / ((key_max_ - key_min_) / num_segments_);
-    if (segment_id > num_segments_ - 1) {
-      segment_id = num_segments_ - 1;
-    }
-
-    // the key should fall into: 
-    //  [ segment_key_boundaries_[i], segment_key_boundaries_[i + 1] ) -- if 0 <= i < num_segments_ - 1
-    //  [ segment_key_boundaries_[i], segment_key_boundaries_[i + 1] ] -- if i == num_segments_ - 1
-    if (segment_id < num_segments_ - 1) {
-
-      ASSERT(segment_key_boundaries_[segment_id] <= key, 
-        "beyond boundary: " << segment_key_boundaries_[segment_id] << " " << key);
-      ASSERT(key < segment_key_boundaries_[segment_id + 1], 
-        "beyond boundary: " << key << " " << segment_key_boundaries_[segment_id + 1]);
-
-    } else {
-
-      ASSERT(segment_id == num_segments_ - 1, 
-        "incorrect segment id: " << segment_id << " " << num_segments_ - 1);
-
-      ASSERT(segment_key_boundaries_[segment_id] <= key, 
-        "beyond boundary: " << segment_key_boundaries_[segment_id] << " " << key);
-      ASSERT(key <= segment_key_boundaries_[segment_id + 1], 
-        "beyond boundary: " << key << " " << segment_key_boundaries_[segment_id + 1]);
-    }
-
-    KeyT segment_key_range = segment_key_boundaries_[segment_id + 1] - segment_key_boundaries_[segment_id];
-    
     // guess where the data lives
-    int64_t guess = int64_t((key - segment_key_boundaries_[segment_id]) * 1.0 / segment_key_range * (segment_sizes_[segment_id] - 1) + segment_offset_boundaries_[segment_id]);
-
-    // TODO: workaround!!
-    if (guess >= this->size_) {
-      guess = this->size_ - 1;
-    }
+    int64_t guess = guess_offset(key);
 
-    int64_t origin_guess = guess;
-    
-    // if the guess is correct
-    if (this->container_[guess].key_ == key) {
+    find_from_guess(key, guess, offsets);
+  }
 
-      stats_.measure_find_op_guess_distance(origin_guess, guess);
+  // the guesses of a group of lookups are computed and prefetched first,
+  // so that the cache misses of their first probes overlap.
+  virtual void find_batch(const KeyT *keys, const size_t count, std::vector<Uint64> *offsets) final {
 
-      offsets.push_back(this->container_[guess].offset_);
-      
-      // move left
-      int64_t guess_lhs = guess - 1;
-      while (guess_lhs >= 0) {
+    const size_t group_size = BaseStaticIndex<KeyT, ValueT>::BATCH_GROUP_SIZE;
 
-        if (this->container_[guess_lhs].key_ == key) {
-          offsets.push_back(this->container_[guess_lhs].offset_);
-          guess_lhs -= 1;
-        } else {
-          break;
-        }
-      }
-      // move right
-      int64_t guess_rhs = guess + 1;
-      while (guess_rhs <= this->size_ - 1) {
+    std::vector<int64_t> guesses(count);
 
-        if (this->container_[guess_rhs].key_ == key) {
-          offsets.push_back(this->container_[guess_rhs].offset_);
-          guess_rhs += 1;
-        } else {
-          break;
-        }
-      }
-    }
-    // if the guess is larger than the key
-    else if (this->container_[guess].key_ > key) {
-      // move left
-      guess -= 1;
-      while (guess >= 0) {
+    for (size_t group_begin = 0; group_begin < count; group_begin += group_size) {
+      size_t group_end = std::min(group_begin + group_size, count);
 
-        if (this->container_[guess].key_ < key) {
-          break;
-        }
-        else if (this->container_[guess].key_ > key) {
-          guess -= 1;
-          continue;
-        } 
-        else {
-
-          stats_.measure_find_op_guess_distance(origin_guess, guess);
-
-          offsets.push_back(this->container_[guess].offset_);
-          guess -= 1;
+      for (size_t i = group_begin; i < group_end; ++i) {
+        if (this->size_ == 0 || keys[i] > key_max_ || keys[i] < key_min_ || key_min_ == key_max_) {
+          // trivial lookups are left to find()
+          guesses[i] = -1;
           continue;
         }
+        guesses[i] = guess_offset(keys[i]);
+        __builtin_prefetch(&this->key_at(guesses[i]));
       }
-    } 
-    // if the guess is smaller than the key
-    else {
-      // move right
-      guess += 1;
-      while (guess < this->size_ - 1) {
-
-        if (this->container_[guess].key_ > key) {
-          break;
-        }
-        else if (this->container_[guess].key_ < key) {
-          guess += 1;
-          continue;
-        }
-        else {
-          
-          stats_.measure_find_op_guess_distance(origin_guess, guess);
 
-          offsets.push_back(this->container_[guess].offset_);
-          guess += 1;
-          continue;
+      for (size_t i = group_begin; i < group_end; ++i) {
+        if (guesses[i] < 0) {
+          find(keys[i], offsets[i]);
+        } else {
+          stats_.increment_find_op_counter();
+          find_from_guess(keys[i], guesses[i], offsets[i]);
         }
       }
     }
-    return;
   }
 
   virtual void find_range(const KeyT &lhs_key, const KeyT &rhs_key, std::vector<Uint64> &offsets) final {
@@ -232,7 +210,7 @@ public:
     if (key_min_ == key_max_) {
       if (key_min_ >= lhs_key && key_min_ <= rhs_key) {
         for (size_t i = 0; i < this->size_; ++i) {
-          offsets.push_back(this->container_[i].offset_);
+          offsets.push_back(this->offset_at(i));
         }
       }
       return;
@@ -241,8 +219,8 @@ public:
     int64_t lower_bound = find_lower_bound(lhs_key);
     int64_t upper_bound = find_upper_bound(rhs_key);
 
-    for (size_t i = lower_bound; i <= upper_bound; ++i) {
-      offsets.push_back(this->container_[i].offset_);
+    for (int64_t i = lower_bound; i <= upper_bound; ++i) {
+      offsets.push_back(this->offset_at(i));
     }
     return;
   }
@@ -252,33 +230,45 @@ public:
 
     this->base_reorganize();
 
-    key_min_ = this->container_[0].key_; // min key
-    key_max_ = this->container_[this->size_ - 1].key_; // max key
+    key_min_ = this->key_at(0); // min key
+    key_max_ = this->key_at(this->size_ - 1); // max key
 
     segment_key_boundaries_[0] = key_min_;
     segment_key_boundaries_[num_segments_] = key_max_;
 
-    KeyT key_range = key_max_ - key_min_;
-    KeyT segment_key_range = key_range / num_segments_;
+    if (segmentation_type_ == SegmentationType::EquiDepthSegmentationType) {
+
+      // each segment starts with the key of every (size_ / num_segments_)-th entry.
+      // duplicate boundaries leave empty segments behind.
+      for (size_t i = 1; i < num_segments_; ++i) {
+        segment_key_boundaries_[i] = this->key_at(this->size_ * i / num_segments_);
+      }
+
+    } else {
+
+      KeyT key_range = key_max_ - key_min_;
+      KeyT segment_key_range = key_range / num_segments_;
 
-    for (size_t i = 1; i < num_segments_; ++i) {
-      segment_key_boundaries_[i] = this->container_[0].key_ + segment_key_range * i;
+      for (size_t i = 1; i < num_segments_; ++i) {
+        segment_key_boundaries_[i] = this->key_at(0) + segment_key_range * i;
+      }
     }
 
-    size_t current_offset = 0;
+    segment_offset_boundaries_[0] = 0;
 
-    segment_offset_boundaries_[0] = current_offset;
+    // each offset boundary is the lower bound of its key boundary.
+    // boundaries are independent, so they are searched in parallel.
+    this->parallel_for(num_segments_ - 1, 1, [&](const size_t begin_segment, const size_t end_segment) {
+      for (size_t i = begin_segment; i < end_segment; ++i) {
+        segment_offset_boundaries_[i + 1] = this->base_lower_bound(segment_key_boundaries_[i + 1], 0, this->size_);
+      }
+    });
 
     for (size_t i = 0; i < num_segments_ - 1; ++i) {
-      // scan the entire table to find offset boundaries
-      while (this->container_[current_offset].key_ < segment_key_boundaries_[i + 1]) {
-        ++segment_sizes_[i];
-        ++current_offset;
-      }
-      segment_offset_boundaries_[i + 1] = current_offset;
+      segment_sizes_[i] = segment_offset_boundaries_[i + 1] - segment_offset_boundaries_[i];
     }
 
-    segment_sizes_[num_segments_ - 1] = this->size_ - current_offset;
+    segment_sizes_[num_segments_ - 1] = this->size_ - segment_offset_boundaries_[num_segments_ - 1];
 
   }
 
@@ -289,10 +279,19 @@ public:
     std::cout << "number of profiled find operations = " << stats_.find_op_profile_count_ << std::endl;
 
     std::cout << "average guess distance = " << stats_.find_op_guess_distance_ * 1.0 / stats_.find_op_profile_count_ << std::endl;
+
+    std::cout << "number of bound searches = " << stats_.get_search_count() << std::endl;
+
+    std::cout << "average probes per bound search = " << stats_.get_search_probe_count() * 1.0 / stats_.get_search_count() << std::endl;
   }
 
 private:
 
+  virtual size_t find_bound(const KeyT &key, const bool is_upper) final {
+    // find_upper_bound() returns the last entry no larger than key
+    return is_upper ? find_upper_bound(key) + 1 : find_lower_bound(key);
+  }
+
   int64_t find_lower_bound(const KeyT &lower_key) {
 
     ASSERT(lower_key <= key_max_, "lower_key must be <= key_max_");
@@ -301,137 +300,149 @@ private:
       return 0;
     }
 
-    size_t segment_id = (lower_key - key_min_) / ((key_max_ - key_min_) / num_segments_);
-    if (segment_id > num_segments_ - 1) {
-      segment_id = num_segments_ - 1;
-    }
+    // guess where the data lives
+    int64_t guess = guess_offset(lower_key);
 
-    // the lower_key should fall into: 
-    //  [ segment_key_boundaries_[i], segment_key_boundaries_[i + 1] ) -- if 0 <= i < num_segments_ - 1
-    //  [ segment_key_boundaries_[i], segment_key_boundaries_[i + 1] ] -- if i == num_segments_ - 1
-    if (segment_id < num_segments_ - 1) {
+    return gallop_bound(lower_key, guess, false);
+  }
+  
+  int64_t find_upper_bound(const KeyT &upper_key) {
+    
+    ASSERT(upper_key >= key_min_, "upper_key must be >= key_min_");
 
-      ASSERT(segment_key_boundaries_[segment_id] <= lower_key, 
-        "beyond boundary: " << segment_key_boundaries_[segment_id] << " " << lower_key);
-      ASSERT(lower_key < segment_key_boundaries_[segment_id + 1], 
-        "beyond boundary: " << lower_key << " " << segment_key_boundaries_[segment_id + 1]);
+    if (upper_key >= key_max_) {
+      return this->size_ - 1;
+    }
 
-    } else {
+    // guess where the data lives
+    int64_t guess = guess_offset(upper_key);
 
-      ASSERT(segment_id == num_segments_ - 1, 
-        "incorrect segment id: " << segment_id << " " << num_segments_ - 1);
+    // the last entry no larger than upper_key precedes its upper bound
+    return gallop_bound(upper_key, guess, true) - 1;
+  }
 
-      ASSERT(segment_key_boundaries_[segment_id] <= lower_key, 
-        "beyond boundary: " << segment_key_boundaries_[segment_id] << " " << lower_key);
-      ASSERT(lower_key <= segment_key_boundaries_[segment_id + 1], 
-        "beyond boundary: " << lower_key << " " << segment_key_boundaries_[segment_id + 1]);
-    }
+  void find_from_guess(const KeyT &key, const int64_t guess, std::vector<Uint64> &offsets) {
 
-    KeyT segment_key_range = segment_key_boundaries_[segment_id + 1] - segment_key_boundaries_[segment_id];
-    // guess where the data lives
-    int64_t guess = int64_t((lower_key - segment_key_boundaries_[segment_id]) * 1.0 / segment_key_range * (segment_sizes_[segment_id] - 1) + segment_offset_boundaries_[segment_id]);
+    // the first entry matching key is the lower bound of key
+    size_t offset_find = gallop_bound(key, guess, false);
 
-    // TODO: workaround!!
-    if (guess >= this->size_) {
-      guess = this->size_ - 1;
+    if (offset_find < this->size_ && this->key_at(offset_find) == key) {
+      stats_.measure_find_op_guess_distance(guess, offset_find);
     }
 
-    if (this->container_[guess].key_ >= lower_key) {
-      // move left
-      while (guess - 1 >= 0) {
-        if (this->container_[guess - 1].key_ >= lower_key) {
-          --guess;
-        } else {
-          return guess;
-        }
-      }
-      return guess;
-
-    } else {
-      // move right
-      ++guess;
-      while (guess < this->size_) {
-        if (this->container_[guess].key_ < lower_key) {
-          ++guess;
-        } else {
-          return guess;
-        }
-      }
-      ASSERT(false, "shouldn't touch this line of code");
-      return guess;
+    while (offset_find < this->size_ && this->key_at(offset_find) == key) {
+      offsets.push_back(this->offset_at(offset_find));
+      ++offset_find;
     }
+  }
 
+  // find the segment of key in the directory of segment key boundaries.
+  // empty segments share their key boundary with the next segment,
+  // so the last segment starting at or before key is taken.
+  size_t find_segment(const KeyT &key) const {
+    size_t segment_id = std::upper_bound(segment_key_boundaries_ + 1, segment_key_boundaries_ + num_segments_, key) - segment_key_boundaries_ - 1;
+    return segment_id;
   }
-  
-  int64_t find_upper_bound(const KeyT &upper_key) {
-    
-    ASSERT(upper_key >= key_min_, "upper_key must be >= key_min_");
 
-    if (upper_key >= key_max_) {
-      return this->size_ - 1;
-    }
+  // interpolate the offset of key in its segment.
+  int64_t guess_offset(const KeyT &key) const {
 
-    size_t segment_id = (upper_key - key_min_) / ((key_max_ - key_min_) / num_segments_);
-    if (segment_id > num_segments_ - 1) {
-      segment_id = num_segments_ - 1;
-    }
+    size_t segment_id = find_segment(key);
 
-    // the upper_key should fall into: 
+    // the key should fall into: 
     //  [ segment_key_boundaries_[i], segment_key_boundaries_[i + 1] ) -- if 0 <= i < num_segments_ - 1
     //  [ segment_key_boundaries_[i], segment_key_boundaries_[i + 1] ] -- if i == num_segments_ - 1
     if (segment_id < num_segments_ - 1) {
 
-      ASSERT(segment_key_boundaries_[segment_id] <= upper_key, 
-        "beyond boundary: " << segment_key_boundaries_[segment_id] << " " << upper_key);
-      ASSERT(upper_key < segment_key_boundaries_[segment_id + 1], 
-        "beyond boundary: " << upper_key << " " << segment_key_boundaries_[segment_id + 1]);
+      ASSERT(segment_key_boundaries_[segment_id] <= key, 
+        "beyond boundary: " << segment_key_boundaries_[segment_id] << " " << key);
+      ASSERT(key < segment_key_boundaries_[segment_id + 1], 
+        "beyond boundary: " << key << " " << segment_key_boundaries_[segment_id + 1]);
 
     } else {
 
       ASSERT(segment_id == num_segments_ - 1, 
         "incorrect segment id: " << segment_id << " " << num_segments_ - 1);
 
-      ASSERT(segment_key_boundaries_[segment_id] <= upper_key, 
-        "beyond boundary: " << segment_key_boundaries_[segment_id] << " " << upper_key);
-      ASSERT(upper_key <= segment_key_boundaries_[segment_id + 1], 
-        "beyond boundary: " << upper_key << " " << segment_key_boundaries_[segment_id + 1]);
+      ASSERT(segment_key_boundaries_[segment_id] <= key, 
+        "beyond boundary: " << segment_key_boundaries_[segment_id] << " " << key);
+      ASSERT(key <= segment_key_boundaries_[segment_id + 1], 
+        "beyond boundary: " << key << " " << segment_key_boundaries_[segment_id + 1]);
     }
 
     KeyT segment_key_range = segment_key_boundaries_[segment_id + 1] - segment_key_boundaries_[segment_id];
-    // guess where the data lives
-    int64_t guess = int64_t((upper_key - segment_key_boundaries_[segment_id]) * 1.0 / segment_key_range * (segment_sizes_[segment_id] - 1) + segment_offset_boundaries_[segment_id]);
 
-    // TODO: workaround!!
-    if (guess >= this->size_) {
+    // the last segment may hold a single distinct key
+    if (segment_key_range == 0 || segment_sizes_[segment_id] == 0) {
+      return std::min(segment_offset_boundaries_[segment_id], this->size_ - 1);
+    }
+
+    int64_t guess = int64_t((key - segment_key_boundaries_[segment_id]) * 1.0 / segment_key_range * (segment_sizes_[segment_id] - 1) + segment_offset_boundaries_[segment_id]);
+
+    if (guess >= (int64_t)this->size_) {
       guess = this->size_ - 1;
     }
+    return guess;
+  }
 
-    if (this->container_[guess].key_ <= upper_key) {
-      // move right
-      while (guess +1 <= this->size_ - 1) {
-        if (this->container_[guess + 1].key_ <= upper_key) {
-          ++guess;
-        } else {
-          return guess;
-        }
+  // return the first offset whose key is no less than key, or larger than key if is_upper is true.
+  // starting from guess, gallop with doubling steps until the bound is bracketed,
+  // then binary search the bracket. this takes O(log d) probes for a guess d entries off.
+  size_t gallop_bound(const KeyT &key, const int64_t guess, const bool is_upper) {
+
+    ASSERT(guess >= 0 && guess < (int64_t)this->size_, "invalid guess: " << guess << " " << this->size_);
+
+    size_t probes = 1;
+    size_t begin_offset, end_offset;
+
+    if (precedes_bound(guess, key, is_upper)) {
+      // move right. the bound is in (guess + step / 2, guess + step]
+      size_t step = 1;
+      begin_offset = guess + 1;
+      end_offset = guess + step;
+      while (end_offset < this->size_ && precedes_bound(end_offset, key, is_upper)) {
+        ++probes;
+        begin_offset = end_offset + 1;
+        step *= 2;
+        end_offset = guess + step;
+      }
+      if (end_offset < this->size_) {
+        ++probes;
       }
-      return guess;
+      end_offset = std::min(end_offset, (size_t)this->size_);
 
     } else {
-      // move left
-      --guess;
-      while (guess > 0) {
-        if (this->container_[guess].key_ > upper_key) {
-          --guess;
-        } else {
-          return guess;
-        }
+      // move left. the bound is in (guess - step, guess - step / 2]
+      size_t step = 1;
+      end_offset = guess;
+      while (step <= (size_t)guess && !precedes_bound(guess - step, key, is_upper)) {
+        ++probes;
+        end_offset = guess - step;
+        step *= 2;
+      }
+      if (step <= (size_t)guess) {
+        ++probes;
+        begin_offset = guess - step + 1;
+      } else {
+        begin_offset = 0;
       }
-      ASSERT(false, "shouldn't touch this line of code");
-      return guess;
     }
 
+    if (end_offset > begin_offset) {
+      probes += 64 - __builtin_clzll(end_offset - begin_offset);
+    }
+    stats_.measure_search_probes(probes);
 
+    if (is_upper) {
+      return this->base_upper_bound(key, begin_offset, end_offset);
+    } else {
+      return this->base_lower_bound(key, begin_offset, end_offset);
+    }
+  }
+
+  // whether the entry at offset is before the bound of key.
+  bool precedes_bound(const size_t offset, const KeyT &key, const bool is_upper) const {
+    return is_upper ? !(key < this->key_at(offset)) : this->key_at(offset) < key;
   }
 
 
@@ -456,7 +467,7 @@ private:
     if (key_min_ == key_max_) {
       if (key_min_ >= lhs_key && key_min_ <= rhs_key) {
         for (size_t i = 0; i < this->size_; ++i) {
-          offsets.push_back(this->container_[i].offset_);
+          offsets.push_back(this->offset_at(i));
         }
       }
       return;
@@ -466,52 +477,19 @@ private:
 
     if (lhs_key > key_min_) {
 
-      // find suitable segment for lhs_key
-      size_t segment_id = (lhs_key - key_min_) / ((key_max_ - key_min_) / num_segments_);
-      if (segment_id > num_segments_ - 1) {
-        segment_id = num_segments_ - 1;
-      }
-
-      // the lhs_key should fall into: 
-      //  [ segment_key_boundaries_[i], segment_key_boundaries_[i + 1] ) -- if 0 <= i < num_segments_ - 1
-      //  [ segment_key_boundaries_[i], segment_key_boundaries_[i + 1] ] -- if i == num_segments_ - 1
-      if (segment_id < num_segments_ - 1) {
-
-        ASSERT(segment_key_boundaries_[segment_id] <= lhs_key, 
-          "beyond boundary: " << segment_key_boundaries_[segment_id] << " " << lhs_key);
-        ASSERT(lhs_key < segment_key_boundaries_[segment_id + 1], 
-          "beyond boundary: " << lhs_key << " " << segment_key_boundaries_[segment_id + 1]);
-
-      } else {
-
-        ASSERT(segment_id == num_segments_ - 1, 
-          "incorrect segment id: " << segment_id << " " << num_segments_ - 1);
-
-        ASSERT(segment_key_boundaries_[segment_id] <= lhs_key, 
-          "beyond boundary: " << segment_key_boundaries_[segment_id] << " " << lhs_key);
-        ASSERT(lhs_key <= segment_key_boundaries_[segment_id + 1], 
-          "beyond boundary: " << lhs_key << " " << segment_key_boundaries_[segment_id + 1]);
-      }
-
-      KeyT segment_key_range = segment_key_boundaries_[segment_id + 1] - segment_key_boundaries_[segment_id];
       // guess where the data lives
-      guess = int64_t((lhs_key - segment_key_boundaries_[segment_id]) * 1.0 / segment_key_range * (segment_sizes_[segment_id] - 1) + segment_offset_boundaries_[segment_id]);
-
-      // TODO: workaround!!
-      if (guess >= this->size_) {
-        guess = this->size_ - 1;
-      }
+      guess = guess_offset(lhs_key);
     }
 
     // if the guess is in [lhs_key, rhs_key]
-    if (this->container_[guess].key_ >= lhs_key && this->container_[guess].key_ <= rhs_key) {
-      offsets.push_back(this->container_[guess].offset_);
+    if (this->key_at(guess) >= lhs_key && this->key_at(guess) <= rhs_key) {
+      offsets.push_back(this->offset_at(guess));
       
       // move left
       int64_t guess_lhs = guess - 1;
       while (guess_lhs >= 0) {
-        if (this->container_[guess_lhs].key_ >= lhs_key) {
-          offsets.push_back(this->container_[guess_lhs].offset_);
+        if (this->key_at(guess_lhs) >= lhs_key) {
+          offsets.push_back(this->offset_at(guess_lhs));
           guess_lhs -= 1;
         } else {
           break;
@@ -520,22 +498,22 @@ private:
       // move right
       int64_t guess_rhs = guess + 1;
       while (guess_rhs <= this->size_ - 1) {
-        if (this->container_[guess_rhs].key_ <= rhs_key) {
-          offsets.push_back(this->container_[guess_rhs].offset_);
+        if (this->key_at(guess_rhs) <= rhs_key) {
+          offsets.push_back(this->offset_at(guess_rhs));
           guess_rhs += 1;
         } else {
           break;
         }
       }
     }
-    else if (this->container_[guess].key_ > rhs_key) {
+    else if (this->key_at(guess) > rhs_key) {
       // move left
       int64_t guess_lhs = guess - 1;
       while (guess_lhs >= 0) {
-        if (this->container_[guess_lhs].key_ < lhs_key) {
+        if (this->key_at(guess_lhs) < lhs_key) {
           break;
-        } else if (this->container_[guess_lhs].key_ <= rhs_key) {
-          offsets.push_back(this->container_[guess_lhs].offset_);
+        } else if (this->key_at(guess_lhs) <= rhs_key) {
+          offsets.push_back(this->offset_at(guess_lhs));
           guess_lhs -= 1;
         } else {
           guess_lhs -= 1;
@@ -547,15 +525,15 @@ private:
       // move right
       guess += 1;
       while (guess < this->size_ - 1) {
-        if (this->container_[guess].key_ < lhs_key) {
+        if (this->key_at(guess) < lhs_key) {
           guess += 1;
           continue;
         }
-        else if (this->container_[guess].key_ > rhs_key) {
+        else if (this->key_at(guess) > rhs_key) {
           break;
         }
         else {
-          offsets.push_back(this->container_[guess].offset_);
+          offsets.push_back(this->offset_at(guess));
           guess += 1;
           continue;
         }
@@ -568,6 +546,8 @@ private:
 
   size_t num_segments_;
 
+  SegmentationType segmentation_type_;
+
   KeyT key_min_;
   KeyT key_max_;
 
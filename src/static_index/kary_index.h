@@ -2,23 +2,56 @@
 
 #include <vector>
 #include <cmath>
+#include <limits>
+#include <algorithm>
+#include <type_traits>
+
+#include <emmintrin.h>
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
 
 #include "base_static_index.h"
 
 
 namespace static_index {
 
+// k-ary search tree.
+// nodes are stored in breadth-first order: the children of node n are nodes n * k + 1 ... n * k + k.
+// each node holds k - 1 separators in a 16-byte aligned slot array padded to whole simd registers,
+// and is searched with simd comparisons. k = 5, 9 and 17 fill the slots of 4-byte keys exactly.
+// separators are stored with their sign bits flipped, as simd instructions only compare signed integers.
 template<typename KeyT, typename ValueT>
 class KAryIndex : public BaseStaticIndex<KeyT, ValueT> {
 
+  static const size_t SIMD_REGISTER_SIZE = 16; // unit: byte
+
+  typedef std::integral_constant<size_t, sizeof(KeyT)> KeySizeTag;
+  typedef typename std::make_signed<KeyT>::type SignedKeyT;
+
+  static const KeyT SIGN_BIT = KeyT(1) << (sizeof(KeyT) * 8 - 1);
+
 public:
-  KAryIndex(DataTable<KeyT, ValueT> *table_ptr, const size_t num_layers, const size_t num_arys) : BaseStaticIndex<KeyT, ValueT>(table_ptr), num_layers_(num_layers), num_arys_(num_arys) {
+  KAryIndex(DataTable<KeyT, ValueT> *table_ptr, const size_t num_layers, const size_t num_arys, const StaticLayoutType layout_type = StaticLayoutType::AoSLayoutType) 
+    : BaseStaticIndex<KeyT, ValueT>(table_ptr, layout_type)
+    , num_layers_(num_layers)
+    , num_arys_(num_arys)
+    , inner_nodes_(nullptr)
+    , inner_node_count_(0) {
+
     ASSERT(num_arys_ >= 2, "num_arys must be larger than or equal to 2");
+
+    // round k - 1 separators up to whole simd registers
+    size_t register_keys = SIMD_REGISTER_SIZE / sizeof(KeyT);
+    node_slots_ = (num_arys_ - 1 + register_keys - 1) / register_keys * register_keys;
   }
 
   virtual ~KAryIndex() {
-    if (num_layers_ != 0) {
-      delete[] inner_nodes_;
+    if (inner_nodes_ != nullptr) {
+      this->free_array(inner_nodes_);
       inner_nodes_ = nullptr;
     }
   }
@@ -35,54 +68,51 @@ public:
     if (key_max_ == key_min_) {
       if (key_max_ == key) {
         for (size_t i = 0; i < this->size_; ++i) {
-          offsets.push_back(this->container_[i].offset_);
+          offsets.push_back(this->offset_at(i));
         }
       }
       return;
     }
 
-    size_t offset_find = this->size_;
-    std::pair<int, int> offset_range = find_inner_layers(key);
-    if (offset_range.first == offset_range.second) {
-      offset_find = offset_range.first;
-    } else {
-      offset_find = find_internal(key, offset_range.first, offset_range.second);
+    // the first entry matching key is the lower bound of key
+    size_t offset_find = find_lower_bound(key);
+
+    while (offset_find < this->size_ && this->key_at(offset_find) == key) {
+      offsets.push_back(this->offset_at(offset_find));
+      ++offset_find;
     }
+  }
+
+  // inner layers are small and stay cached, so each lookup descends them on its own.
+  // the searches over the sorted entries, which miss the cache, are then interleaved.
+  virtual void find_batch(const KeyT *keys, const size_t count, std::vector<Uint64> *offsets) final {
 
-    if (offset_find == this->size_) {
-      // find nothing
+    if (this->size_ == 0) {
       return;
     }
 
-    offsets.push_back(this->container_[offset_find].offset_);
-
-    // move left
-    int offset_find_lhs = offset_find - 1;
-    while (offset_find_lhs >= 0) {
+    std::vector<size_t> begin_offsets(count);
+    std::vector<size_t> end_offsets(count);
 
-      if (this->container_[offset_find_lhs].key_ == key) {
-        offsets.push_back(this->container_[offset_find_lhs].offset_);
-        offset_find_lhs -= 1;
-      } else {
-        break;
-      }
-    }
-    // move right
-    int offset_find_rhs = offset_find + 1;
-    while (offset_find_rhs <= this->size_ - 1) {
-
-      if (this->container_[offset_find_rhs].key_ == key) {
-        offsets.push_back(this->container_[offset_find_rhs].offset_);
-        offset_find_rhs += 1;
-      } else {
-        break;
+    for (size_t i = 0; i < count; ++i) {
+      if (keys[i] > key_max_ || keys[i] < key_min_ || key_max_ == key_min_) {
+        // the lower bound is the first entry, which matches only if all keys are equal
+        begin_offsets[i] = 0;
+        end_offsets[i] = 0;
+        continue;
       }
+      std::pair<int64_t, int64_t> offset_range = find_inner_layers(keys[i], false);
+      begin_offsets[i] = offset_range.first;
+      end_offsets[i] = offset_range.second + 1;
     }
+
+    this->base_find_batch(keys, count, begin_offsets.data(), end_offsets.data(), offsets);
   }
 
 
   virtual void find_range(const KeyT &lhs_key, const KeyT &rhs_key, std::vector<Uint64> &offsets) final {
-    ASSERT(lhs_key < rhs_key, "lhs_key must be smaller than rhs_key: " << lhs_key << " " << rhs_key);
+
+    if (lhs_key > rhs_key) { return; }
 
     if (this->size_ == 0) {
       return;
@@ -91,6 +121,19 @@ public:
       return;
     }
 
+    size_t lhs_offset = find_lower_bound(lhs_key);
+    size_t rhs_offset = find_upper_bound(rhs_key);
+
+    this->base_copy_offsets(lhs_offset, rhs_offset, offsets);
+  }
+
+  // the inner layers need fewer nodes than entries
+  virtual size_t get_min_size() const final {
+    size_t min_size = 1;
+    for (size_t i = 0; i < num_layers_; ++i) {
+      min_size *= num_arys_;
+    }
+    return min_size;
   }
 
   virtual void reorganize() final {
@@ -101,24 +144,34 @@ public:
 
     ASSERT(inner_node_count_ < this->size_, "exceed maximum layers");
 
-    key_min_ = this->container_[0].key_;
-    key_max_ = this->container_[this->size_ - 1].key_;
+    key_min_ = this->key_at(0);
+    key_max_ = this->key_at(this->size_ - 1);
+
+    if (inner_nodes_ != nullptr) {
+      this->free_array(inner_nodes_);
+      inner_nodes_ = nullptr;
+    }
 
     if (num_layers_ != 0) {
 
-      inner_nodes_ = new KeyT[inner_node_count_];
-      construct_inner_layers();
+      size_t node_count = inner_node_count_ / (num_arys_ - 1);
+      inner_nodes_ = this->template allocate_array<KeyT>(node_count * node_slots_);
 
-    } else {
-      inner_nodes_ = nullptr;
+      // padding slots hold the largest key, which precedes no lower bound.
+      std::fill(inner_nodes_, inner_nodes_ + node_count * node_slots_, flip_sign(std::numeric_limits<KeyT>::max()));
+
+      construct_inner_layers();
     }
   }
 
   virtual void print() const final {
     if (inner_nodes_ != nullptr) {
 
-      for (size_t i = 0; i < inner_node_count_; ++i) {
-        std::cout << inner_nodes_[i] << " ";
+      size_t node_count = inner_node_count_ / (num_arys_ - 1);
+      for (size_t node = 0; node < node_count; ++node) {
+        for (size_t i = 0; i < num_arys_ - 1; ++i) {
+          std::cout << flip_sign(inner_nodes_[node * node_slots_ + i]) << " ";
+        }
       }
       std::cout << std::endl;
     }
@@ -126,132 +179,197 @@ public:
 
 private:
 
+  // build inner nodes layer by layer.
+  // nodes in a layer cover disjoint ranges, so each layer is built in parallel.
   void construct_inner_layers() {
     ASSERT (num_layers_ != 0, "number of layers cannot be 0");
 
-    size_t begin_offset = 0;
-    size_t end_offset = this->size_ - 1;
+    // offset ranges covered by the nodes in the current layer
+    std::vector<std::pair<int64_t, int64_t>> curr_ranges(1, std::pair<int64_t, int64_t>(0, this->size_ - 1));
+    std::vector<std::pair<int64_t, int64_t>> next_ranges;
 
-    size_t step_offset = (end_offset - begin_offset) / num_arys_;
-    
-    // construct the first layer (layer 0)
-    for (size_t i = 0; i < num_arys_ - 1; ++i) {
-      ASSERT(i < inner_node_count_, 
-        "out of array: " << i << " " << inner_node_count_);
+    // id of the first node in the current layer
+    size_t base_node = 0;
 
-      inner_nodes_[i] = this->container_[begin_offset + step_offset * (i + 1)].key_;
-    }
-    if (num_layers_ == 1) { return; }
+    for (size_t curr_layer = 0; curr_layer < num_layers_; ++curr_layer) {
+      bool is_last_layer = (curr_layer + 1 == num_layers_);
+      if (!is_last_layer) {
+        next_ranges.resize(curr_ranges.size() * num_arys_);
+      }
 
-    size_t base_pos = num_arys_ - 1;
-    size_t next_layer = 1;
+      this->parallel_for(curr_ranges.size(), this->PARALLEL_GRAIN_SIZE, [&](const size_t begin_node, const size_t end_node) {
+        for (size_t node = begin_node; node < end_node; ++node) {
+          int64_t begin_offset = curr_ranges[node].first;
+          int64_t end_offset = curr_ranges[node].second;
+          KeyT *dst_node = inner_nodes_ + (base_node + node) * node_slots_;
+
+          if (begin_offset > end_offset) {
+            // children of an empty node are empty
+            if (!is_last_layer) {
+              for (size_t i = 0; i < num_arys_; ++i) {
+                next_ranges[node * num_arys_ + i] = curr_ranges[node];
+              }
+            }
+            continue;
+          }
+
+          int64_t step_offset = (end_offset - begin_offset) / num_arys_;
+
+          for (size_t i = 0; i < num_arys_ - 1; ++i) {
+            dst_node[i] = flip_sign(this->key_at(begin_offset + step_offset * (i + 1)));
+          }
+
+          if (!is_last_layer) {
+            // construct num_arys_ children
+            std::pair<int64_t, int64_t> *children = &next_ranges[node * num_arys_];
+            children[0] = std::pair<int64_t, int64_t>(begin_offset, begin_offset + step_offset - 1);
+            for (size_t i = 1; i < num_arys_ - 1; ++i) {
+              children[i] = std::pair<int64_t, int64_t>(begin_offset + step_offset * i + 1, begin_offset + step_offset * (i + 1) - 1);
+            }
+            children[num_arys_ - 1] = std::pair<int64_t, int64_t>(begin_offset + step_offset * (num_arys_ - 1) + 1, end_offset);
+          }
+        }
+      });
 
-    // construct (num_arys_ + 1) children
-    construct_inner_layers_internal(begin_offset, begin_offset + step_offset - 1, base_pos, 0, next_layer);
-    for (size_t i = 1; i < num_arys_ - 1; ++i) {
-      construct_inner_layers_internal(begin_offset + step_offset * i + 1, begin_offset + step_offset * (i + 1) - 1, base_pos, i * (num_arys_ - 1), next_layer);
+      curr_ranges.swap(next_ranges);
+      base_node = base_node * num_arys_ + 1;
     }
-    construct_inner_layers_internal(begin_offset + step_offset * (num_arys_ - 1) + 1, end_offset, base_pos, (num_arys_ - 1) * (num_arys_ - 1), next_layer);
   }
 
-  void construct_inner_layers_internal(const int begin_offset, const int end_offset, const size_t base_pos, const size_t dst_pos, const size_t curr_layer) {
-    if (begin_offset > end_offset) { return; }
-
-    size_t step_offset = (end_offset - begin_offset) / num_arys_;
-    
-    for (size_t i = 0; i < num_arys_ - 1; ++i) {
-      ASSERT(base_pos + dst_pos + i < inner_node_count_, 
-        "out of array: " << (base_pos + dst_pos + i) << " " << inner_node_count_);
+  virtual size_t find_bound(const KeyT &key, const bool is_upper) final {
+    return is_upper ? find_upper_bound(key) : find_lower_bound(key);
+  }
 
-      inner_nodes_[base_pos + dst_pos + i] = this->container_[begin_offset + step_offset * (i + 1)].key_;
-    }
-    if (num_layers_ == curr_layer + 1) { return; }
-
-    size_t new_base_pos = (base_pos + 1) * num_arys_ - 1;
-    size_t new_dst_pos = dst_pos * num_arys_;
-    size_t next_layer = curr_layer + 1;
-    construct_inner_layers_internal(begin_offset, begin_offset + step_offset - 1, new_base_pos, new_dst_pos, next_layer);
-    for (size_t i = 1; i < num_arys_ - 1; ++i) {
-      construct_inner_layers_internal(begin_offset + step_offset * i + 1, begin_offset + step_offset * (i + 1) - 1, new_base_pos, new_dst_pos + i * (num_arys_ - 1), next_layer);
-    }
-    construct_inner_layers_internal(begin_offset + step_offset * (num_arys_ - 1) + 1, end_offset, new_base_pos, new_dst_pos + (num_arys_ - 1) * (num_arys_ - 1), next_layer);
+  // return the first offset whose key is no less than key.
+  size_t find_lower_bound(const KeyT &key) {
+    std::pair<int64_t, int64_t> offset_range = find_inner_layers(key, false);
+    return this->base_lower_bound(key, offset_range.first, offset_range.second + 1);
   }
 
-  // binary search
-  // this function directly find key in leaf nodes
-  size_t find_internal(const KeyT &key, const int offset_begin, const int offset_end) {
-    if (offset_begin > offset_end) {
-      return this->size_;
-    }
-    int offset_lookup = (offset_begin + offset_end) / 2;
-    KeyT key_lookup = this->container_[offset_lookup].key_;
-    if (key == key_lookup) {
-      return offset_lookup;
-    }
-    if (key > key_lookup) {
-      return find_internal(key, offset_lookup + 1, offset_end);
-    } else {
-      return find_internal(key, offset_begin, offset_lookup - 1);
-    }
+  // return the first offset whose key is larger than key.
+  size_t find_upper_bound(const KeyT &key) {
+    std::pair<int64_t, int64_t> offset_range = find_inner_layers(key, true);
+    return this->base_upper_bound(key, offset_range.first, offset_range.second + 1);
   }
 
-  // find key in inner nodes
-  std::pair<int, int> find_inner_layers(const KeyT &key) {
+  // descend inner nodes to the leaf range [first, second] holding the bound.
+  // the bound is either in this range or right after it.
+  std::pair<int64_t, int64_t> find_inner_layers(const KeyT &key, const bool is_upper = false) {
 
-    if (num_layers_ == 0) { return std::pair<int, int>(0, this->size_); }
+    int64_t begin_offset = 0;
+    int64_t end_offset = this->size_ - 1;
+    size_t node = 0;
 
-    int begin_offset = 0;
-    int end_offset = this->size_ - 1;
+    KeyT flipped_key = flip_sign(key);
 
-    size_t step_offset = (end_offset - begin_offset) / num_arys_;
+    for (size_t curr_layer = 0; curr_layer < num_layers_; ++curr_layer) {
+      if (begin_offset > end_offset) { break; }
 
-    for (size_t i = 0; i < num_arys_ - 1; ++i) {
-      if (key == inner_nodes_[i]) { return std::pair<int, int>(begin_offset + step_offset * (i + 1), begin_offset + step_offset * (i + 1)); }
-    }
+      int64_t step_offset = (end_offset - begin_offset) / num_arys_;
 
-    size_t base_pos = num_arys_ - 1;
-    size_t next_layer = 1;
+      // child i covers the keys between separator i - 1 and separator i.
+      // with is_upper, padding slots precede the largest key, so cap the count.
+      size_t i = count_preceding(flipped_key, inner_nodes_ + node * node_slots_, is_upper, KeySizeTag());
+      i = std::min(i, num_arys_ - 1);
 
-    if (key < inner_nodes_[0]) {
-      return find_inner_layers_internal(key, begin_offset, begin_offset + step_offset - 1, base_pos, 0, next_layer);
-    }
+      node = node * num_arys_ + 1 + i;
 
-    for (size_t i = 1; i < num_arys_ - 1; ++i) {
-      if (key < inner_nodes_[i]) {
-        return find_inner_layers_internal(key, begin_offset + step_offset * i + 1, begin_offset + step_offset * (i + 1) - 1, base_pos, i * (num_arys_ - 1), next_layer);
+      if (i != num_arys_ - 1) {
+        end_offset = begin_offset + step_offset * (i + 1) - 1;
+      }
+      if (i != 0) {
+        begin_offset = begin_offset + step_offset * i + 1;
       }
     }
+    return std::pair<int64_t, int64_t>(begin_offset, end_offset);
+  }
 
-    return find_inner_layers_internal(key, begin_offset + step_offset * (num_arys_ - 1) + 1, end_offset, base_pos, (num_arys_ - 1) * (num_arys_ - 1), next_layer);
+  KeyT flip_sign(const KeyT key) const {
+    return key ^ SIGN_BIT;
   }
 
-  // helper function for find_inner_layers()
-  std::pair<int, int> find_inner_layers_internal(const KeyT &key, const int begin_offset, const int end_offset, const size_t base_pos, const size_t dst_pos, const size_t curr_layer) {
+  // count the slots of a node that are smaller than key, or no larger than key if is_upper is true.
+  // key and slots are sign-flipped.
+  size_t count_preceding(const KeyT &key, const KeyT *node, const bool is_upper, std::integral_constant<size_t, 4>) const {
 
-    if (num_layers_ == curr_layer) { return std::pair<int, int>(begin_offset, end_offset); }
+    size_t count = 0;
+    size_t i = 0;
 
-    size_t step_offset = (end_offset - begin_offset) / num_arys_;
+#if defined(__AVX2__) || defined(__AVX512F__)
 
-    for (size_t i = 0; i < num_arys_ - 1; ++i) {
-      if (key == inner_nodes_[base_pos + dst_pos + i]) { 
-        return std::pair<int, int>(begin_offset + step_offset * (i + 1), begin_offset + step_offset * (i + 1)); }
+    __m256i ymm_key_q = _mm256_set1_epi32(key);
+    for (; i + 8 <= node_slots_; i += 8) {
+      __m256i ymm_node = _mm256_loadu_si256((const __m256i*)(node + i));
+      unsigned mask = is_upper ?
+        _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(ymm_node, ymm_key_q))) ^ 0xff :
+        _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(ymm_key_q, ymm_node)));
+      count += __builtin_popcount(mask);
     }
 
-    size_t new_base_pos = (base_pos + 1) * num_arys_ - 1;
-    size_t new_dst_pos = dst_pos * num_arys_;
-    size_t next_layer = curr_layer + 1;
+#endif
 
-    if (key < inner_nodes_[base_pos + dst_pos]) {
-      return find_inner_layers_internal(key, begin_offset, begin_offset + step_offset - 1, new_base_pos, new_dst_pos, next_layer);
+    __m128i xmm_key_q = _mm_set1_epi32(key);
+    for (; i < node_slots_; i += 4) {
+      __m128i xmm_node = _mm_load_si128((const __m128i*)(node + i));
+      unsigned mask = is_upper ?
+        _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(xmm_node, xmm_key_q))) ^ 0xf :
+        _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(xmm_key_q, xmm_node)));
+      count += __builtin_popcount(mask);
     }
+    return count;
+  }
 
-    for (size_t i = 1; i < num_arys_ - 1; ++i) {
-      if (key < inner_nodes_[base_pos + dst_pos + i]) {
-        return find_inner_layers_internal(key, begin_offset + step_offset * i + 1, begin_offset + step_offset * (i + 1) - 1, new_base_pos, new_dst_pos + i * (num_arys_ - 1), next_layer);
-      }
+  size_t count_preceding(const KeyT &key, const KeyT *node, const bool is_upper, std::integral_constant<size_t, 8>) const {
+
+#if defined(__SSE4_2__) || defined(__AVX2__) || defined(__AVX512F__)
+
+    size_t count = 0;
+    size_t i = 0;
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+
+    __m256i ymm_key_q = _mm256_set1_epi64x(key);
+    for (; i + 4 <= node_slots_; i += 4) {
+      __m256i ymm_node = _mm256_loadu_si256((const __m256i*)(node + i));
+      unsigned mask = is_upper ?
+        _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(ymm_node, ymm_key_q))) ^ 0xf :
+        _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(ymm_key_q, ymm_node)));
+      count += __builtin_popcount(mask);
+    }
+
+#endif
+
+    __m128i xmm_key_q = _mm_set1_epi64x(key);
+    for (; i < node_slots_; i += 2) {
+      __m128i xmm_node = _mm_load_si128((const __m128i*)(node + i));
+      unsigned mask = is_upper ?
+        _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(xmm_node, xmm_key_q))) ^ 0x3 :
+        _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(xmm_key_q, xmm_node)));
+      count += __builtin_popcount(mask);
     }
+    return count;
+
+#else
+
+    // no 64-bit simd comparison below SSE4.2
+    return scalar_count_preceding(key, node, is_upper);
 
-    return find_inner_layers_internal(key, begin_offset + step_offset * (num_arys_ - 1) + 1, end_offset, new_base_pos, new_dst_pos + (num_arys_ - 1) * (num_arys_ - 1), next_layer);
+#endif
+  }
+
+  template<size_t KeySize>
+  size_t count_preceding(const KeyT &key, const KeyT *node, const bool is_upper, std::integral_constant<size_t, KeySize>) const {
+    return scalar_count_preceding(key, node, is_upper);
+  }
+
+  size_t scalar_count_preceding(const KeyT &key, const KeyT *node, const bool is_upper) const {
+    size_t i = 0;
+    for (; i < num_arys_ - 1; ++i) {
+      if ((SignedKeyT)key < (SignedKeyT)node[i] || (!is_upper && key == node[i])) {
+        break;
+      }
+    }
+    return i;
   }
 
 
@@ -263,7 +381,10 @@ private:
   KeyT key_min_;
   KeyT key_max_;
   KeyT *inner_nodes_;
+  // number of separators
   size_t inner_node_count_;
+  // number of key slots per node
+  size_t node_slots_;
 
 };
 
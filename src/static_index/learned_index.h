@@ -0,0 +1,282 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#include "base_static_index.h"
+
+namespace static_index {
+
+// two-level recursive model index (RMI).
+// a linear root model maps a key to one of num_models_ leaf models,
+// and the leaf model predicts the offset of the key in the sorted entries.
+// each leaf records the range of its prediction errors over the entries mapped to it,
+// so that a lookup only binary searches the error window around the prediction.
+// models are least-squares fits over sorted entries, so their slopes are non-negative
+// and predictions are monotone in key. hence the bounds of any key, stored or not,
+// fall in its window.
+template<typename KeyT, typename ValueT>
+class LearnedIndex : public BaseStaticIndex<KeyT, ValueT> {
+
+  struct LinearModel {
+
+    LinearModel() : slope_(0), key_mean_(0), offset_mean_(0) {}
+
+    double predict(const KeyT &key) const {
+      return slope_ * ((double)key - key_mean_) + offset_mean_;
+    }
+
+    double slope_;
+    double key_mean_;
+    double offset_mean_;
+  };
+
+  struct LeafModel {
+
+    LeafModel() : begin_offset_(0), end_offset_(0), min_error_(0), max_error_(0) {}
+
+    LinearModel model_;
+
+    // entries in [begin_offset_, end_offset_) are mapped to this leaf
+    size_t begin_offset_;
+    size_t end_offset_;
+
+    // range of (offset - prediction) over the entries mapped to this leaf
+    double min_error_;
+    double max_error_;
+  };
+
+public:
+  LearnedIndex(DataTable<KeyT, ValueT> *table_ptr, const size_t num_models, const StaticLayoutType layout_type = StaticLayoutType::AoSLayoutType)
+    : BaseStaticIndex<KeyT, ValueT>(table_ptr, layout_type)
+    , num_models_(num_models) {
+
+    ASSERT(num_models_ >= 1, "must have at least one model");
+  }
+
+  virtual ~LearnedIndex() {}
+
+  virtual void find(const KeyT &key, std::vector<Uint64> &offsets) final {
+
+    if (this->size_ == 0) {
+      return;
+    }
+
+    if (key > key_max_ || key < key_min_) {
+      return;
+    }
+
+    size_t begin_offset, end_offset;
+    predict_window(key, begin_offset, end_offset);
+
+    // the first entry matching key is the lower bound of key
+    size_t offset_find = this->base_lower_bound(key, begin_offset, end_offset);
+
+    while (offset_find < this->size_ && this->key_at(offset_find) == key) {
+      offsets.push_back(this->offset_at(offset_find));
+      ++offset_find;
+    }
+  }
+
+  virtual void find_range(const KeyT &lhs_key, const KeyT &rhs_key, std::vector<Uint64> &offsets) final {
+
+    if (lhs_key > rhs_key) { return; }
+
+    if (this->size_ == 0) {
+      return;
+    }
+    if (lhs_key > key_max_ || rhs_key < key_min_) {
+      return;
+    }
+
+    size_t begin_offset, end_offset;
+
+    predict_window(lhs_key, begin_offset, end_offset);
+    size_t lhs_offset = this->base_lower_bound(lhs_key, begin_offset, end_offset);
+
+    predict_window(rhs_key, begin_offset, end_offset);
+    size_t rhs_offset = this->base_upper_bound(rhs_key, begin_offset, end_offset);
+
+    this->base_copy_offsets(lhs_offset, rhs_offset, offsets);
+  }
+
+  virtual void reorganize() final {
+
+    this->base_reorganize();
+
+    key_min_ = this->key_at(0);
+    key_max_ = this->key_at(this->size_ - 1);
+
+    // train the root model over all entries, then scale it to leaf ids.
+    root_ = fit_model(0, this->size_);
+    double scale = num_models_ * 1.0 / this->size_;
+    root_.slope_ *= scale;
+    root_.offset_mean_ *= scale;
+
+    leaves_.clear();
+    leaves_.resize(num_models_);
+
+    // leaf ids are monotone in offsets, so each leaf holds a contiguous range of entries.
+    this->parallel_for(num_models_, 1, [&](const size_t begin_model, const size_t end_model) {
+      for (size_t i = begin_model; i < end_model; ++i) {
+        leaves_[i].begin_offset_ = find_first_offset_of_leaf(i);
+      }
+    });
+
+    for (size_t i = 0; i + 1 < num_models_; ++i) {
+      leaves_[i].end_offset_ = leaves_[i + 1].begin_offset_;
+    }
+    leaves_[num_models_ - 1].end_offset_ = this->size_;
+
+    this->parallel_for(num_models_, 1, [&](const size_t begin_model, const size_t end_model) {
+      for (size_t i = begin_model; i < end_model; ++i) {
+        train_leaf(leaves_[i]);
+      }
+    });
+  }
+
+  virtual void print() const final {
+
+    double max_window = 0;
+    double sum_window = 0;
+    size_t non_empty_count = 0;
+
+    for (auto &leaf : leaves_) {
+      if (leaf.begin_offset_ == leaf.end_offset_) { continue; }
+
+      double window = leaf.max_error_ - leaf.min_error_ + 1;
+      max_window = std::max(max_window, window);
+      sum_window += window * (leaf.end_offset_ - leaf.begin_offset_);
+      ++non_empty_count;
+    }
+
+    std::cout << "number of models = " << num_models_ << " (" << non_empty_count << " non-empty)" << std::endl;
+
+    std::cout << "average error window = " << sum_window / this->size_ << std::endl;
+
+    std::cout << "maximum error window = " << max_window << std::endl;
+  }
+
+private:
+
+  virtual size_t find_bound(const KeyT &key, const bool is_upper) final {
+    size_t begin_offset, end_offset;
+    predict_window(key, begin_offset, end_offset);
+
+    if (is_upper) {
+      return this->base_upper_bound(key, begin_offset, end_offset);
+    } else {
+      return this->base_lower_bound(key, begin_offset, end_offset);
+    }
+  }
+
+  // least-squares linear fit of offsets over keys in [begin_offset, end_offset).
+  LinearModel fit_model(const size_t begin_offset, const size_t end_offset) const {
+
+    LinearModel model;
+
+    size_t count = end_offset - begin_offset;
+    if (count == 0) {
+      return model;
+    }
+
+    for (size_t i = begin_offset; i < end_offset; ++i) {
+      model.key_mean_ += (double)this->key_at(i);
+    }
+    model.key_mean_ /= count;
+    model.offset_mean_ = (begin_offset + end_offset - 1) / 2.0;
+
+    double covariance = 0;
+    double variance = 0;
+    for (size_t i = begin_offset; i < end_offset; ++i) {
+      double key_delta = (double)this->key_at(i) - model.key_mean_;
+      covariance += key_delta * (i - model.offset_mean_);
+      variance += key_delta * key_delta;
+    }
+
+    // keys are sorted, so covariance is non-negative.
+    if (variance > 0) {
+      model.slope_ = std::max(covariance / variance, 0.0);
+    }
+    return model;
+  }
+
+  void train_leaf(LeafModel &leaf) const {
+
+    leaf.model_ = fit_model(leaf.begin_offset_, leaf.end_offset_);
+    leaf.min_error_ = 0;
+    leaf.max_error_ = 0;
+
+    for (size_t i = leaf.begin_offset_; i < leaf.end_offset_; ++i) {
+      double error = i - leaf.model_.predict(this->key_at(i));
+      if (i == leaf.begin_offset_ || error < leaf.min_error_) {
+        leaf.min_error_ = error;
+      }
+      if (i == leaf.begin_offset_ || error > leaf.max_error_) {
+        leaf.max_error_ = error;
+      }
+    }
+  }
+
+  size_t find_leaf(const KeyT &key) const {
+    double leaf_id = root_.predict(key);
+    if (!(leaf_id > 0)) {
+      return 0;
+    }
+    if (leaf_id >= num_models_ - 1) {
+      return num_models_ - 1;
+    }
+    return (size_t)leaf_id;
+  }
+
+  // return the first offset whose entry is mapped to leaf leaf_id or a later leaf.
+  size_t find_first_offset_of_leaf(const size_t leaf_id) const {
+    size_t begin_offset = 0;
+    size_t end_offset = this->size_;
+    while (begin_offset < end_offset) {
+      size_t mid_offset = begin_offset + (end_offset - begin_offset) / 2;
+      if (find_leaf(this->key_at(mid_offset)) < leaf_id) {
+        begin_offset = mid_offset + 1;
+      } else {
+        end_offset = mid_offset;
+      }
+    }
+    return begin_offset;
+  }
+
+  // compute the range [begin_offset, end_offset] that holds both the lower and the upper bound of key.
+  // the window is widened by one entry on each side to absorb floating-point rounding.
+  void predict_window(const KeyT &key, size_t &begin_offset, size_t &end_offset) const {
+
+    const LeafModel &leaf = leaves_[find_leaf(key)];
+
+    double guess = leaf.model_.predict(key);
+
+    double lhs = std::floor(guess + leaf.min_error_) - 1;
+    double rhs = std::ceil(guess + leaf.max_error_) + 2;
+
+    // the bounds of a key mapped to this leaf never leave its entries
+    lhs = std::min(std::max(lhs, (double)leaf.begin_offset_), (double)leaf.end_offset_);
+    rhs = std::min(std::max(rhs, (double)leaf.begin_offset_), (double)leaf.end_offset_);
+
+    begin_offset = (size_t)lhs;
+    end_offset = (size_t)rhs;
+  }
+
+private:
+
+  size_t num_models_;
+
+  KeyT key_min_;
+  KeyT key_max_;
+
+  // maps a key to a leaf id
+  LinearModel root_;
+
+  // there are num_models_ leaves in total
+  std::vector<LeafModel> leaves_;
+
+};
+
+}
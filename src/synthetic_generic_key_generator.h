@@ -1,5 +1,7 @@
 #pragma once
 
+#include <string>
+
 #include "fast_random.h"
 
 #include "base_generic_key_generator.h"
@@ -11,11 +13,12 @@ public:
   virtual ~SyntheticGenericKeyGenerator() {}
 
   virtual void get_next_key(GenericKey &key) final {
-    key.resize(key_size_);
-    fast_rand_.next_readable_chars(key.size(), key.raw());
+    fast_rand_.next_readable_string(key_size_, key_bytes_);
+    key.assign(key_bytes_.data(), key_bytes_.size());
   }
 
 private:
   FastRandom fast_rand_;
   size_t key_size_;
+  std::string key_bytes_;
 };
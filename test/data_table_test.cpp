@@ -1,4 +1,6 @@
 #include <map>
+#include <string>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -14,7 +16,7 @@ class DataTableTest : public IndexZooTest {};
 
 
 template<typename KeyT>
-void data_table_numeric_test() {
+void data_table_numeric_test(const uint64_t max_block_capacity = MaxBlockCapacity, const BlockPlacementType placement_type = BlockPlacementType::FirstTouchPlacementType, const TableLayoutType layout_type = TableLayoutType::RowLayoutType) {
   // size_t n = 54321;
   size_t n = 1000;
 
@@ -22,7 +24,7 @@ void data_table_numeric_test() {
   std::vector<std::pair<KeyT, uint64_t>> test_vector;
 
   std::unique_ptr<DataTable<KeyT, uint64_t>> data_table(
-    new DataTable<KeyT, uint64_t>());
+    new DataTable<KeyT, uint64_t>(max_block_capacity, placement_type, layout_type));
 
   // insert
   for (size_t i = 0; i < n; ++i) {
@@ -47,7 +49,23 @@ void data_table_numeric_test() {
   for (size_t i = 0; i < test_vector.size(); ++i) {
     EXPECT_EQ(test_vector.at(i).first, validation_vector.at(i).first);
     EXPECT_EQ(test_vector.at(i).second, validation_vector.at(i).second);
+    EXPECT_EQ(*(data_table->get_tuple_value(test_vector.at(i).second)), i + 2048);
   }
+
+  // key-only and value-only streaming
+  DataTableIterator<KeyT, uint64_t> key_iterator(data_table.get());
+  DataTableIterator<KeyT, uint64_t> value_iterator(data_table.get());
+  for (size_t i = 0; i < n; ++i) {
+    Uint64 key_offset = 0;
+    Uint64 value_offset = 0;
+    EXPECT_TRUE(key_iterator.has_next());
+    EXPECT_EQ(key_iterator.next_key(key_offset), validation_vector.at(i).first);
+    EXPECT_EQ(value_iterator.next_value(value_offset), i + 2048);
+    EXPECT_EQ(key_offset, validation_vector.at(i).second);
+    EXPECT_EQ(value_offset, validation_vector.at(i).second);
+  }
+  EXPECT_FALSE(key_iterator.has_next());
+  EXPECT_FALSE(value_iterator.has_next());
 }
 
 TEST_F(DataTableTest, NumericTest) {
@@ -56,52 +74,126 @@ TEST_F(DataTableTest, NumericTest) {
   data_table_numeric_test<uint64_t>();
 }
 
+TEST_F(DataTableTest, BlockCapacityTest) {
+  // blocks of a single tuple, and blocks spanning several pages
+  data_table_numeric_test<uint32_t>(1);
+  data_table_numeric_test<uint32_t>(64);
+  data_table_numeric_test<uint64_t>(1ull << 20);
+
+  data_table_numeric_test<uint64_t>(64, BlockPlacementType::LocalNodePlacementType);
+  data_table_numeric_test<uint64_t>(MaxBlockCapacity, BlockPlacementType::LocalNodePlacementType);
+}
+
+TEST_F(DataTableTest, ColumnLayoutTest) {
+  data_table_numeric_test<uint16_t>(1, BlockPlacementType::FirstTouchPlacementType, TableLayoutType::ColumnLayoutType);
+  data_table_numeric_test<uint32_t>(64, BlockPlacementType::FirstTouchPlacementType, TableLayoutType::ColumnLayoutType);
+  data_table_numeric_test<uint64_t>(MaxBlockCapacity, BlockPlacementType::FirstTouchPlacementType, TableLayoutType::ColumnLayoutType);
+}
+
 
-void data_table_generic_test(const uint64_t max_key_size) {
+void data_table_generic_test(const uint64_t max_key_size, const uint64_t max_block_capacity = MaxBlockCapacity) {
   // size_t n = 54321;
   size_t n = 1000;
 
-  std::vector<std::pair<char*, uint64_t>> validation_vector;
-  std::vector<std::pair<char*, uint64_t>> test_vector;
+  std::vector<std::pair<std::string, uint64_t>> validation_vector;
+  std::vector<std::pair<std::string, uint64_t>> test_vector;
 
   std::unique_ptr<GenericDataTable> data_table(
-    new GenericDataTable(max_key_size, sizeof(uint64_t)));
+    new GenericDataTable(max_key_size, sizeof(uint64_t), max_block_capacity));
 
   FastRandom fast_rand(0);
 
-  GenericKey key(max_key_size);
-  // insert
+  // insert keys of 0 to max_key_size bytes
   for (size_t i = 0; i < n; ++i) {
 
-    fast_rand.next_readable_chars(max_key_size, key.raw());
+    std::string key;
+    fast_rand.next_string(fast_rand.next<uint16_t>() % (max_key_size + 1), key);
     uint64_t value = i + 2048;
     
-    OffsetT offset = data_table->insert_tuple(key.raw(), max_key_size, (char*)(&value), sizeof(uint64_t));
+    OffsetT offset = data_table->insert_tuple(key.data(), key.size(), (char*)(&value), sizeof(uint64_t));
 
-    char *tmp = new char[max_key_size];
-    memcpy(tmp, key.raw(), max_key_size);
-    validation_vector.emplace_back(std::pair<char*, uint64_t>(tmp, offset.raw_data()));
+    validation_vector.emplace_back(std::pair<std::string, uint64_t>(key, offset.raw_data()));
   }
 
   GenericDataTableIterator iterator(data_table.get());
   while (iterator.has_next()) {
     auto entry = iterator.next();
-    test_vector.emplace_back(std::pair<char*, uint64_t>(entry.key_, entry.offset_));
+    test_vector.emplace_back(std::pair<std::string, uint64_t>(std::string(entry.key_.raw(), entry.key_.size()), entry.offset_));
+
+    EXPECT_EQ(entry.value_.size(), sizeof(uint64_t));
   }
 
   EXPECT_EQ(validation_vector.size(), n);
   EXPECT_EQ(test_vector.size(), n);
 
   for (size_t i = 0; i < test_vector.size(); ++i) {
-    EXPECT_EQ(strncmp(test_vector.at(i).first, validation_vector.at(i).first, max_key_size), 0);
+    EXPECT_EQ(test_vector.at(i).first, validation_vector.at(i).first);
     EXPECT_EQ(test_vector.at(i).second, validation_vector.at(i).second);
-  }
 
-  for (size_t i = 0; i < test_vector.size(); ++i) {
-    delete[] validation_vector.at(i).first;
+    TupleView key = data_table->get_tuple_key(validation_vector.at(i).second);
+    TupleView value = data_table->get_tuple_value(validation_vector.at(i).second);
+    EXPECT_EQ(std::string(key.raw(), key.size()), validation_vector.at(i).first);
+    EXPECT_EQ(value.size(), sizeof(uint64_t));
+    EXPECT_EQ(*(uint64_t*)(value.raw()), i + 2048);
   }
 }
 
 TEST_F(DataTableTest, GenericTest) {
   data_table_generic_test(16);
+  data_table_generic_test(255);
+  data_table_generic_test(255, 64);
+}
+
+
+template<typename KeyT>
+void data_table_numeric_concurrent_test(const size_t thread_count) {
+  size_t n = 10000;
+
+  // small blocks, so that every thread fills many of them
+  std::unique_ptr<DataTable<KeyT, uint64_t>> data_table(
+    new DataTable<KeyT, uint64_t>(1024));
+
+  std::vector<std::vector<std::pair<KeyT, uint64_t>>> validation_vectors(thread_count);
+
+  // each thread inserts its own keys
+  std::vector<std::thread> threads;
+  for (size_t thread_id = 0; thread_id < thread_count; ++thread_id) {
+    threads.emplace_back([&, thread_id]() {
+      for (size_t i = 0; i < n; ++i) {
+
+        KeyT key = i * thread_count + thread_id;
+        uint64_t value = i + 2048;
+
+        OffsetT offset = data_table->insert_tuple(key, value);
+
+        validation_vectors[thread_id].emplace_back(std::pair<KeyT, uint64_t>(key, offset.raw_data()));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  std::map<uint64_t, KeyT> test_map;
+
+  DataTableIterator<KeyT, uint64_t> iterator(data_table.get());
+  while (iterator.has_next()) {
+    auto entry = iterator.next();
+    test_map[entry.offset_] = *(entry.key_);
+  }
+
+  EXPECT_EQ(data_table->size(), n * thread_count);
+  EXPECT_EQ(test_map.size(), n * thread_count);
+
+  for (auto &validation_vector : validation_vectors) {
+    for (auto &entry : validation_vector) {
+      EXPECT_EQ(*(data_table->get_tuple_key(entry.second)), entry.first);
+      EXPECT_EQ(test_map[entry.second], entry.first);
+    }
+  }
+}
+
+TEST_F(DataTableTest, NumericConcurrentTest) {
+  data_table_numeric_concurrent_test<uint32_t>(4);
+  data_table_numeric_concurrent_test<uint64_t>(8);
 }
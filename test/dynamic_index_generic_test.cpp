@@ -1,4 +1,5 @@
 #include <map>
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -15,6 +16,13 @@
 
 class DynamicIndexGenericTest : public IndexZooTest {};
 
+// fill key with key_size random readable bytes
+void next_readable_key(FastRandom &rand, const size_t key_size, GenericKey &key) {
+  std::string key_bytes;
+  rand.next_readable_string(key_size, key_bytes);
+  key.assign(key_bytes.data(), key_bytes.size());
+}
+
 void test_dynamic_index_generic_unique_key_find(const uint64_t max_key_size, const IndexType index_type) {
 
   size_t n = 10000;
@@ -38,7 +46,7 @@ void test_dynamic_index_generic_unique_key_find(const uint64_t max_key_size, con
   // insert
   for (size_t i = 0; i < n; ++i) {
 
-    rand.next_readable_chars(key_size, key.raw());
+    next_readable_key(rand, key_size, key);
 
     ValueT value = i + 2048;
 
@@ -61,7 +69,7 @@ void test_dynamic_index_generic_unique_key_find(const uint64_t max_key_size, con
 
     EXPECT_EQ(offsets.size(), 1);
 
-    char *value = data_table->get_tuple_value(offsets.at(0));
+    char *value = data_table->get_tuple_value(offsets.at(0)).raw();
 
     EXPECT_EQ(offsets.at(0), entry.second.first);
 
@@ -118,7 +126,7 @@ void test_dynamic_index_generic_non_unique_key_find(const uint64_t max_key_size,
   GenericKey key(key_size);
   
   for (size_t i = 0; i < m; ++i) {
-    rand_gen.next_readable_chars(key_size, key.raw());
+    next_readable_key(rand_gen, key_size, key);
     unique_keys.push_back(key);
   }
 
@@ -148,7 +156,7 @@ void test_dynamic_index_generic_non_unique_key_find(const uint64_t max_key_size,
     EXPECT_EQ(offsets.size(), entry.second.size());
 
     for (auto offset : offsets) {
-      char *value = data_table->get_tuple_value(offset);
+      char *value = data_table->get_tuple_value(offset).raw();
 
       EXPECT_NE(entry.second.end(), entry.second.find(offset));
 
@@ -203,10 +211,10 @@ void test_dynamic_index_generic_unique_key_find_range(const uint64_t max_key_siz
   // insert
   for (size_t i = 0; i < n; ++i) {
 
-    rand.next_readable_chars(key_size, key.raw());
+    next_readable_key(rand, key_size, key);
 
     while (validation_set.find(key) != validation_set.end()) {
-      rand.next_readable_chars(key_size, key.raw());
+      next_readable_key(rand, key_size, key);
     }
 
     uint64_t value = i + 2048;
@@ -296,7 +304,7 @@ void test_dynamic_index_generic_non_unique_key_find_range(const uint64_t max_key
   GenericKey rand_key(key_size);
 
   for (size_t i = 0; i < m; ++i) {
-    rand_gen.next_readable_chars(key_size, rand_key.raw());
+    next_readable_key(rand_gen, key_size, rand_key);
     unique_keys.push_back(rand_key);
   }
   
@@ -394,7 +402,7 @@ void test_dynamic_index_generic_scan(const uint64_t max_key_size, const IndexTyp
   // insert
   for (size_t i = 0; i < n; ++i) {
 
-    rand.next_readable_chars(max_key_size, key.raw());
+    next_readable_key(rand, max_key_size, key);
     uint64_t value = i + 2048;
     
     OffsetT offset = data_table->insert_tuple(key.raw(), key.size(), (char*)(&value), sizeof(uint64_t));
@@ -441,3 +449,67 @@ TEST_F(DynamicIndexGenericTest, ScanTest) {
 }
 
 
+
+
+void test_dynamic_index_generic_binary_key_find(const uint64_t max_key_size, const IndexType index_type) {
+
+  size_t n = 10000;
+
+  std::unique_ptr<GenericDataTable> data_table(
+    new GenericDataTable(max_key_size, sizeof(uint64_t)));
+  std::unique_ptr<BaseGenericIndex> data_index(
+    create_generic_index(index_type, data_table.get()));
+
+  data_index->prepare_threads(1);
+  data_index->register_thread(0);
+
+  std::map<GenericKey, std::pair<Uint64, uint64_t>> validation_set;
+
+  FastRandom rand;
+
+  GenericKey key(max_key_size);
+  // insert keys holding zero bytes, so that key sizes cannot be recovered with strlen
+  for (size_t i = 0; i < n; ++i) {
+
+    std::string key_bytes;
+    rand.next_string(max_key_size, key_bytes);
+    key_bytes[i % max_key_size] = 0;
+    key.assign(key_bytes.data(), key_bytes.size());
+    uint64_t value = i + 2048;
+    
+    OffsetT offset = data_table->insert_tuple(key.raw(), key.size(), (char*)(&value), sizeof(uint64_t));
+
+    EXPECT_EQ(data_table->get_tuple_key_size(offset), max_key_size);
+
+    validation_set.insert(
+      std::pair<GenericKey, std::pair<Uint64, uint64_t>>(
+        key, std::pair<Uint64, uint64_t>(offset.raw_data(), value)));
+
+    data_index->insert(key, offset.raw_data());
+  }
+
+  // find
+  for (auto entry : validation_set) {
+
+    std::vector<Uint64> offsets;
+
+    data_index->find(entry.first, offsets);
+
+    EXPECT_EQ(offsets.size(), 1);
+    EXPECT_EQ(offsets.at(0), entry.second.first);
+  }
+}
+
+
+TEST_F(DynamicIndexGenericTest, BinaryKeyFindTest) {
+
+  std::vector<IndexType> index_types {
+    IndexType::D_ST_StxBtree,
+    IndexType::D_MT_ArtTree,
+  };
+
+  for (auto index_type : index_types) {
+    test_dynamic_index_generic_binary_key_find(32, index_type);
+    test_dynamic_index_generic_binary_key_find(64, index_type);
+  }
+}
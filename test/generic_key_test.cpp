@@ -0,0 +1,192 @@
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "generic_key.h"
+#include "fast_random.h"
+
+#include "harness.h"
+
+
+class GenericKeyTest : public IndexZooTest {};
+
+
+// empty keys are built from nullptr
+GenericKey make_generic_key(const std::string &bytes) {
+  return GenericKey(bytes.empty() ? nullptr : bytes.data(), bytes.size());
+}
+
+
+void generic_key_copy_move_test(const size_t key_size) {
+
+  FastRandom fast_rand(key_size);
+
+  std::string bytes;
+  fast_rand.next_string(key_size, bytes);
+
+  GenericKey key = make_generic_key(bytes);
+  EXPECT_EQ(key.size(), key_size);
+  EXPECT_EQ(std::string(key.raw(), key.size()), bytes);
+
+  // copy
+  GenericKey copy_key(key);
+  EXPECT_TRUE(copy_key == key);
+  if (key_size != 0) {
+    EXPECT_NE(copy_key.raw(), key.raw());
+  }
+
+  GenericKey assign_key(key_size + 1);
+  assign_key = key;
+  EXPECT_TRUE(assign_key == key);
+
+  // self assignment
+  assign_key = *(&assign_key);
+  EXPECT_TRUE(assign_key == key);
+
+  // move
+  GenericKey move_key(std::move(copy_key));
+  EXPECT_TRUE(move_key == key);
+  EXPECT_EQ(copy_key.size(), 0);
+
+  GenericKey move_assign_key(key_size + 1);
+  move_assign_key = std::move(move_key);
+  EXPECT_TRUE(move_assign_key == key);
+  EXPECT_EQ(move_key.size(), 0);
+
+  // moved-from keys can be reused
+  move_key = key;
+  EXPECT_TRUE(move_key == key);
+
+  // keys move between containers without losing their bytes
+  std::vector<GenericKey> keys;
+  for (size_t i = 0; i < 100; ++i) {
+    keys.push_back(key);
+  }
+  for (auto &entry : keys) {
+    EXPECT_TRUE(entry == key);
+  }
+
+  // growing a vector moves heap keys instead of copying their bytes
+  if (key_size > GenericKey::INLINE_SIZE) {
+    const char *first_data = keys[0].raw();
+    keys.reserve(keys.capacity() * 2);
+    EXPECT_EQ(first_data, keys[0].raw());
+  }
+
+  // a borrowed key points to the bytes of the view, and its copies own their bytes
+  GenericKeyView view(key);
+  GenericKey borrowed_key = GenericKey::borrow(view);
+  EXPECT_EQ(borrowed_key.raw(), key.raw());
+  EXPECT_TRUE(borrowed_key == key);
+
+  GenericKey owned_key(borrowed_key);
+  EXPECT_TRUE(owned_key == key);
+  if (key_size != 0) {
+    EXPECT_NE(owned_key.raw(), key.raw());
+  }
+
+  // resize
+  owned_key.resize(key_size + GenericKey::INLINE_SIZE);
+  EXPECT_EQ(owned_key.size(), key_size + GenericKey::INLINE_SIZE);
+  for (size_t i = 0; i < owned_key.size(); ++i) {
+    EXPECT_EQ(owned_key.raw()[i], 0);
+  }
+}
+
+TEST_F(GenericKeyTest, CopyMoveTest) {
+  // empty, inline, and heap keys
+  generic_key_copy_move_test(0);
+  generic_key_copy_move_test(8);
+  generic_key_copy_move_test(GenericKey::INLINE_SIZE);
+  generic_key_copy_move_test(GenericKey::INLINE_SIZE + 1);
+  generic_key_copy_move_test(64);
+}
+
+TEST_F(GenericKeyTest, CompareTest) {
+
+  FastRandom fast_rand(0);
+
+  for (size_t i = 0; i < 1000; ++i) {
+    std::string lhs_bytes;
+    std::string rhs_bytes;
+    fast_rand.next_string(fast_rand.next<uint8_t>() % 40, lhs_bytes);
+    fast_rand.next_string(fast_rand.next<uint8_t>() % 40, rhs_bytes);
+
+    // share prefixes now and then
+    if (i % 2 == 0) {
+      rhs_bytes = lhs_bytes.substr(0, rhs_bytes.size()) + rhs_bytes.substr(std::min(rhs_bytes.size(), lhs_bytes.size()));
+    }
+
+    GenericKey lhs_key = make_generic_key(lhs_bytes);
+    GenericKey rhs_key = make_generic_key(rhs_bytes);
+
+    EXPECT_EQ(lhs_key < rhs_key, lhs_bytes < rhs_bytes);
+    EXPECT_EQ(lhs_key > rhs_key, lhs_bytes > rhs_bytes);
+    EXPECT_EQ(lhs_key == rhs_key, lhs_bytes == rhs_bytes);
+    EXPECT_EQ(GenericKeyComparator()(lhs_key, rhs_key), lhs_bytes < rhs_bytes);
+    EXPECT_EQ(GenericKeyEqualityChecker()(lhs_key, rhs_key), lhs_bytes == rhs_bytes);
+  }
+}
+
+TEST_F(GenericKeyTest, PrefixTest) {
+
+  // short keys are zero padded, so prefixes alone cannot order them
+  GenericKey short_key = make_generic_key(std::string("ab"));
+  GenericKey padded_key = make_generic_key(std::string("ab\0", 3));
+  EXPECT_EQ(short_key.prefix(), padded_key.prefix());
+  EXPECT_TRUE(short_key < padded_key);
+  EXPECT_FALSE(short_key == padded_key);
+
+  // keys differing only after the prefix
+  GenericKey lhs_key = make_generic_key(std::string("abcdefgh0"));
+  GenericKey rhs_key = make_generic_key(std::string("abcdefgh1"));
+  EXPECT_EQ(lhs_key.prefix(), rhs_key.prefix());
+  EXPECT_TRUE(lhs_key < rhs_key);
+
+  // the prefix follows writes
+  GenericKey key(4);
+  EXPECT_EQ(key.prefix(), 0);
+  key.assign("abcd", 4);
+  EXPECT_EQ(key.prefix(), make_generic_key(std::string("abcd")).prefix());
+  key.resize(16);
+  EXPECT_EQ(key.prefix(), 0);
+}
+
+template<typename HasherT>
+void generic_key_hasher_test() {
+
+  FastRandom fast_rand(0);
+
+  GenericKeyHasher<HasherT> hasher;
+
+  for (size_t key_size = 0; key_size < 40; ++key_size) {
+    std::string bytes;
+    fast_rand.next_string(key_size, bytes);
+
+    GenericKey key = make_generic_key(bytes);
+    GenericKey copy_key(key);
+    EXPECT_EQ(hasher(key), hasher(copy_key));
+
+    // trailing zero bytes change the hash
+    GenericKey padded_key = make_generic_key(bytes + std::string(1, '\0'));
+    EXPECT_NE(hasher(key), hasher(padded_key));
+
+    // the fixed-size fast paths hash the same bytes to the same value
+    if (key_size == 8) {
+      uint64_t numeric_key;
+      memcpy(&numeric_key, bytes.data(), key_size);
+      EXPECT_EQ(hasher(key), (NumericKeyHasher<uint64_t, HasherT>()(numeric_key)));
+    }
+    if (key_size != 8 && key_size != 16) {
+      EXPECT_EQ(hasher(key), HasherT::hash_bytes(bytes.data(), bytes.size()));
+    }
+  }
+}
+
+TEST_F(GenericKeyTest, HasherTest) {
+  generic_key_hasher_test<CityHasher>();
+  generic_key_hasher_test<Crc32cHasher>();
+  generic_key_hasher_test<WyHasher>();
+}
@@ -1,4 +1,6 @@
+#include <atomic>
 #include <map>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -68,6 +70,11 @@ TEST_F(StaticIndexNumericTest, UniqueKeyFindTest) {
     test_static_index_numeric_unique_key_find<uint32_t, uint64_t>(index_type, segments, INVALID_INDEX_PARAM);
     test_static_index_numeric_unique_key_find<uint64_t, uint64_t>(index_type, segments, INVALID_INDEX_PARAM);
   }
+  for (size_t segments = 1; segments <= 10; ++segments) {
+    test_static_index_numeric_unique_key_find<uint16_t, uint64_t>(index_type, segments, (size_t)SegmentationType::EquiDepthSegmentationType);
+    test_static_index_numeric_unique_key_find<uint32_t, uint64_t>(index_type, segments, (size_t)SegmentationType::EquiDepthSegmentationType);
+    test_static_index_numeric_unique_key_find<uint64_t, uint64_t>(index_type, segments, (size_t)SegmentationType::EquiDepthSegmentationType);
+  }
 
   index_type = IndexType::S_Binary;
   for (size_t layers = 0; layers < 8; ++layers) {
@@ -88,13 +95,33 @@ TEST_F(StaticIndexNumericTest, UniqueKeyFindTest) {
   index_type = IndexType::S_Fast;
   for (size_t layers = 0; layers <= 12; layers += 4) {
     test_static_index_numeric_unique_key_find<uint32_t, uint64_t>(index_type, layers, INVALID_INDEX_PARAM);
+    test_static_index_numeric_unique_key_find<uint64_t, uint64_t>(index_type, layers, INVALID_INDEX_PARAM);
+  }
+
+  index_type = IndexType::S_Eytzinger;
+  test_static_index_numeric_unique_key_find<uint16_t, uint64_t>(index_type, INVALID_INDEX_PARAM, INVALID_INDEX_PARAM);
+  test_static_index_numeric_unique_key_find<uint32_t, uint64_t>(index_type, INVALID_INDEX_PARAM, INVALID_INDEX_PARAM);
+  test_static_index_numeric_unique_key_find<uint64_t, uint64_t>(index_type, INVALID_INDEX_PARAM, INVALID_INDEX_PARAM);
+
+  index_type = IndexType::S_Learned;
+  for (size_t models : {1, 16, 1000}) {
+    test_static_index_numeric_unique_key_find<uint16_t, uint64_t>(index_type, models, INVALID_INDEX_PARAM);
+    test_static_index_numeric_unique_key_find<uint32_t, uint64_t>(index_type, models, INVALID_INDEX_PARAM);
+    test_static_index_numeric_unique_key_find<uint64_t, uint64_t>(index_type, models, INVALID_INDEX_PARAM);
+  }
+
+  index_type = IndexType::S_Compressed;
+  for (size_t block_size : {1, 16, 128}) {
+    test_static_index_numeric_unique_key_find<uint16_t, uint64_t>(index_type, block_size, INVALID_INDEX_PARAM);
+    test_static_index_numeric_unique_key_find<uint32_t, uint64_t>(index_type, block_size, INVALID_INDEX_PARAM);
+    test_static_index_numeric_unique_key_find<uint64_t, uint64_t>(index_type, block_size, INVALID_INDEX_PARAM);
   }
 
 }
 
 
 template<typename KeyT, typename ValueT>
-void test_static_index_numeric_non_unique_key_find(const IndexType index_type, const size_t index_param_1, const size_t index_param_2) {
+void test_static_index_numeric_non_unique_key_find(const IndexType index_type, const size_t index_param_1, const size_t index_param_2, const StaticLayoutType layout_type = StaticLayoutType::AoSLayoutType, const size_t thread_count = 1, const StaticAllocationType allocation_type = StaticAllocationType::DefaultAllocationType) {
 
   size_t n = 10000;
   size_t m = 1000;
@@ -104,7 +131,10 @@ void test_static_index_numeric_non_unique_key_find(const IndexType index_type, c
   std::unique_ptr<DataTable<KeyT, ValueT>> data_table(
     new DataTable<KeyT, ValueT>());
   std::unique_ptr<BaseIndex<KeyT, ValueT>> data_index(
-    create_numeric_index<KeyT, ValueT>(index_type, data_table.get(), index_param_1, index_param_2));
+    create_numeric_index<KeyT, ValueT>(index_type, data_table.get(), index_param_1, index_param_2, layout_type));
+
+  data_index->prepare_threads(thread_count);
+  dynamic_cast<BaseStaticIndex<KeyT, ValueT>*>(data_index.get())->set_allocation_type(allocation_type);
 
   std::unordered_map<KeyT, std::unordered_map<Uint64, ValueT>> validation_set;
 
@@ -151,6 +181,11 @@ TEST_F(StaticIndexNumericTest, NonUniqueKeyFindTest) {
     test_static_index_numeric_non_unique_key_find<uint32_t, uint64_t>(index_type, segments, INVALID_INDEX_PARAM);
     test_static_index_numeric_non_unique_key_find<uint64_t, uint64_t>(index_type, segments, INVALID_INDEX_PARAM);
   }
+  for (size_t segments = 1; segments <= 10; ++segments) {
+    test_static_index_numeric_non_unique_key_find<uint16_t, uint64_t>(index_type, segments, (size_t)SegmentationType::EquiDepthSegmentationType);
+    test_static_index_numeric_non_unique_key_find<uint32_t, uint64_t>(index_type, segments, (size_t)SegmentationType::EquiDepthSegmentationType);
+    test_static_index_numeric_non_unique_key_find<uint64_t, uint64_t>(index_type, segments, (size_t)SegmentationType::EquiDepthSegmentationType);
+  }
 
   index_type = IndexType::S_Binary;
   for (size_t layers = 0; layers < 8; ++layers) {
@@ -167,12 +202,220 @@ TEST_F(StaticIndexNumericTest, NonUniqueKeyFindTest) {
       test_static_index_numeric_non_unique_key_find<uint64_t, uint64_t>(index_type, layers, k);
     }
   }
+  // node sizes matching simd widths
+  for (size_t layers = 0; layers < 3; ++layers) {
+    for (size_t k : {5, 9, 17}) {
+      test_static_index_numeric_non_unique_key_find<uint16_t, uint64_t>(index_type, layers, k);
+      test_static_index_numeric_non_unique_key_find<uint32_t, uint64_t>(index_type, layers, k);
+      test_static_index_numeric_non_unique_key_find<uint64_t, uint64_t>(index_type, layers, k);
+    }
+  }
 
   index_type = IndexType::S_Fast;
   for (size_t layers = 0; layers <= 12; layers += 4) {
     test_static_index_numeric_non_unique_key_find<uint32_t, uint64_t>(index_type, layers, INVALID_INDEX_PARAM);
+    test_static_index_numeric_non_unique_key_find<uint64_t, uint64_t>(index_type, layers, INVALID_INDEX_PARAM);
+  }
+
+  index_type = IndexType::S_Eytzinger;
+  test_static_index_numeric_non_unique_key_find<uint16_t, uint64_t>(index_type, INVALID_INDEX_PARAM, INVALID_INDEX_PARAM);
+  test_static_index_numeric_non_unique_key_find<uint32_t, uint64_t>(index_type, INVALID_INDEX_PARAM, INVALID_INDEX_PARAM);
+  test_static_index_numeric_non_unique_key_find<uint64_t, uint64_t>(index_type, INVALID_INDEX_PARAM, INVALID_INDEX_PARAM);
+
+  index_type = IndexType::S_Learned;
+  for (size_t models : {1, 16, 1000}) {
+    test_static_index_numeric_non_unique_key_find<uint16_t, uint64_t>(index_type, models, INVALID_INDEX_PARAM);
+    test_static_index_numeric_non_unique_key_find<uint32_t, uint64_t>(index_type, models, INVALID_INDEX_PARAM);
+    test_static_index_numeric_non_unique_key_find<uint64_t, uint64_t>(index_type, models, INVALID_INDEX_PARAM);
+  }
+
+  index_type = IndexType::S_Compressed;
+  for (size_t block_size : {1, 16, 128}) {
+    test_static_index_numeric_non_unique_key_find<uint16_t, uint64_t>(index_type, block_size, INVALID_INDEX_PARAM);
+    test_static_index_numeric_non_unique_key_find<uint32_t, uint64_t>(index_type, block_size, INVALID_INDEX_PARAM);
+    test_static_index_numeric_non_unique_key_find<uint64_t, uint64_t>(index_type, block_size, INVALID_INDEX_PARAM);
+  }
+
+}
+
+TEST_F(StaticIndexNumericTest, SoANonUniqueKeyFindTest) {
+
+  StaticLayoutType layout_type = StaticLayoutType::SoALayoutType;
+
+  IndexType index_type = IndexType::S_Interpolation;
+  test_static_index_numeric_non_unique_key_find<uint16_t, uint64_t>(index_type, 4, INVALID_INDEX_PARAM, layout_type);
+  test_static_index_numeric_non_unique_key_find<uint32_t, uint64_t>(index_type, 4, INVALID_INDEX_PARAM, layout_type);
+  test_static_index_numeric_non_unique_key_find<uint64_t, uint64_t>(index_type, 4, INVALID_INDEX_PARAM, layout_type);
+
+  index_type = IndexType::S_Binary;
+  for (size_t layers = 0; layers < 8; layers += 3) {
+    test_static_index_numeric_non_unique_key_find<uint16_t, uint64_t>(index_type, layers, INVALID_INDEX_PARAM, layout_type);
+    test_static_index_numeric_non_unique_key_find<uint32_t, uint64_t>(index_type, layers, INVALID_INDEX_PARAM, layout_type);
+    test_static_index_numeric_non_unique_key_find<uint64_t, uint64_t>(index_type, layers, INVALID_INDEX_PARAM, layout_type);
+  }
+
+  index_type = IndexType::S_KAry;
+  for (size_t layers = 0; layers < 4; layers += 2) {
+    test_static_index_numeric_non_unique_key_find<uint16_t, uint64_t>(index_type, layers, 3, layout_type);
+    test_static_index_numeric_non_unique_key_find<uint32_t, uint64_t>(index_type, layers, 3, layout_type);
+    test_static_index_numeric_non_unique_key_find<uint64_t, uint64_t>(index_type, layers, 3, layout_type);
   }
 
+  index_type = IndexType::S_Fast;
+  for (size_t layers = 0; layers <= 12; layers += 4) {
+    test_static_index_numeric_non_unique_key_find<uint32_t, uint64_t>(index_type, layers, INVALID_INDEX_PARAM, layout_type);
+  }
+
+  index_type = IndexType::S_Eytzinger;
+  test_static_index_numeric_non_unique_key_find<uint16_t, uint64_t>(index_type, INVALID_INDEX_PARAM, INVALID_INDEX_PARAM, layout_type);
+  test_static_index_numeric_non_unique_key_find<uint32_t, uint64_t>(index_type, INVALID_INDEX_PARAM, INVALID_INDEX_PARAM, layout_type);
+  test_static_index_numeric_non_unique_key_find<uint64_t, uint64_t>(index_type, INVALID_INDEX_PARAM, INVALID_INDEX_PARAM, layout_type);
+
+  index_type = IndexType::S_Learned;
+  test_static_index_numeric_non_unique_key_find<uint16_t, uint64_t>(index_type, 100, INVALID_INDEX_PARAM, layout_type);
+  test_static_index_numeric_non_unique_key_find<uint32_t, uint64_t>(index_type, 100, INVALID_INDEX_PARAM, layout_type);
+  test_static_index_numeric_non_unique_key_find<uint64_t, uint64_t>(index_type, 100, INVALID_INDEX_PARAM, layout_type);
+
+}
+
+TEST_F(StaticIndexNumericTest, ParallelNonUniqueKeyFindTest) {
+
+  size_t thread_count = 4;
+
+  IndexType index_type = IndexType::S_Interpolation;
+  test_static_index_numeric_non_unique_key_find<uint32_t, uint64_t>(index_type, 4, INVALID_INDEX_PARAM, StaticLayoutType::AoSLayoutType, thread_count);
+  test_static_index_numeric_non_unique_key_find<uint64_t, uint64_t>(index_type, 4, INVALID_INDEX_PARAM, StaticLayoutType::SoALayoutType, thread_count);
+
+  index_type = IndexType::S_Binary;
+  test_static_index_numeric_non_unique_key_find<uint32_t, uint64_t>(index_type, 7, INVALID_INDEX_PARAM, StaticLayoutType::AoSLayoutType, thread_count);
+  test_static_index_numeric_non_unique_key_find<uint64_t, uint64_t>(index_type, 7, INVALID_INDEX_PARAM, StaticLayoutType::SoALayoutType, thread_count);
+
+  index_type = IndexType::S_KAry;
+  test_static_index_numeric_non_unique_key_find<uint32_t, uint64_t>(index_type, 3, 4, StaticLayoutType::AoSLayoutType, thread_count);
+  test_static_index_numeric_non_unique_key_find<uint64_t, uint64_t>(index_type, 3, 4, StaticLayoutType::SoALayoutType, thread_count);
+
+  index_type = IndexType::S_Fast;
+  test_static_index_numeric_non_unique_key_find<uint32_t, uint64_t>(index_type, 8, INVALID_INDEX_PARAM, StaticLayoutType::AoSLayoutType, thread_count);
+  test_static_index_numeric_non_unique_key_find<uint32_t, uint64_t>(index_type, 8, INVALID_INDEX_PARAM, StaticLayoutType::SoALayoutType, thread_count);
+
+  index_type = IndexType::S_Eytzinger;
+  test_static_index_numeric_non_unique_key_find<uint32_t, uint64_t>(index_type, INVALID_INDEX_PARAM, INVALID_INDEX_PARAM, StaticLayoutType::AoSLayoutType, thread_count);
+  test_static_index_numeric_non_unique_key_find<uint64_t, uint64_t>(index_type, INVALID_INDEX_PARAM, INVALID_INDEX_PARAM, StaticLayoutType::SoALayoutType, thread_count);
+
+  index_type = IndexType::S_Learned;
+  test_static_index_numeric_non_unique_key_find<uint32_t, uint64_t>(index_type, 100, INVALID_INDEX_PARAM, StaticLayoutType::AoSLayoutType, thread_count);
+  test_static_index_numeric_non_unique_key_find<uint64_t, uint64_t>(index_type, 100, INVALID_INDEX_PARAM, StaticLayoutType::SoALayoutType, thread_count);
+
+  index_type = IndexType::S_Compressed;
+  test_static_index_numeric_non_unique_key_find<uint64_t, uint64_t>(index_type, 64, INVALID_INDEX_PARAM, StaticLayoutType::SoALayoutType, thread_count);
+
+}
+
+TEST_F(StaticIndexNumericTest, HugePageNonUniqueKeyFindTest) {
+
+  StaticAllocationType allocation_type = StaticAllocationType::HugePageAllocationType;
+
+  IndexType index_type = IndexType::S_Interpolation;
+  test_static_index_numeric_non_unique_key_find<uint64_t, uint64_t>(index_type, 4, INVALID_INDEX_PARAM, StaticLayoutType::AoSLayoutType, 1, allocation_type);
+  test_static_index_numeric_non_unique_key_find<uint64_t, uint64_t>(index_type, 4, INVALID_INDEX_PARAM, StaticLayoutType::SoALayoutType, 4, allocation_type);
+
+  index_type = IndexType::S_Binary;
+  test_static_index_numeric_non_unique_key_find<uint32_t, uint64_t>(index_type, 7, INVALID_INDEX_PARAM, StaticLayoutType::AoSLayoutType, 1, allocation_type);
+
+  index_type = IndexType::S_KAry;
+  test_static_index_numeric_non_unique_key_find<uint32_t, uint64_t>(index_type, 3, 4, StaticLayoutType::AoSLayoutType, 1, allocation_type);
+
+  index_type = IndexType::S_Fast;
+  test_static_index_numeric_non_unique_key_find<uint32_t, uint64_t>(index_type, 8, INVALID_INDEX_PARAM, StaticLayoutType::SoALayoutType, 1, allocation_type);
+
+  index_type = IndexType::S_Eytzinger;
+  test_static_index_numeric_non_unique_key_find<uint64_t, uint64_t>(index_type, INVALID_INDEX_PARAM, INVALID_INDEX_PARAM, StaticLayoutType::AoSLayoutType, 1, allocation_type);
+
+}
+
+template<typename KeyT, typename ValueT>
+void test_static_index_numeric_non_unique_key_find_batch(const IndexType index_type, const size_t index_param_1, const size_t index_param_2) {
+
+  size_t n = 10000;
+  size_t m = 1000;
+  
+  FastRandom rand_gen(0);
+
+  std::unique_ptr<DataTable<KeyT, ValueT>> data_table(
+    new DataTable<KeyT, ValueT>());
+  std::unique_ptr<BaseIndex<KeyT, ValueT>> data_index(
+    create_numeric_index<KeyT, ValueT>(index_type, data_table.get(), index_param_1, index_param_2));
+
+  std::unordered_map<KeyT, std::unordered_map<Uint64, ValueT>> validation_set;
+
+  // insert
+  for (size_t i = 0; i < n; ++i) {
+
+    KeyT key = rand_gen.next<KeyT>() % m;
+    ValueT value = i + 2048;
+    
+    OffsetT offset = data_table->insert_tuple(key, value);
+    
+    validation_set[key][offset.raw_data()] = value;
+  }
+
+  // reorganize data
+  data_index->reorganize();
+
+  // look up all keys in [0, m + 10) at once, some of which do not exist
+  std::vector<KeyT> keys;
+  for (size_t i = 0; i < m + 10; ++i) {
+    keys.push_back(i);
+  }
+
+  std::vector<std::vector<Uint64>> offsets(keys.size());
+
+  data_index->find_batch(keys.data(), keys.size(), offsets.data());
+
+  for (size_t i = 0; i < keys.size(); ++i) {
+    if (validation_set.find(keys[i]) == validation_set.end()) {
+      EXPECT_EQ(offsets[i].size(), 0);
+      continue;
+    }
+
+    auto &entry = validation_set.at(keys[i]);
+
+    EXPECT_EQ(offsets[i].size(), entry.size());
+
+    for (auto offset : offsets[i]) {
+      EXPECT_NE(entry.end(), entry.find(offset));
+    }
+  }
+}
+
+TEST_F(StaticIndexNumericTest, NonUniqueKeyFindBatchTest) {
+
+  IndexType index_type = IndexType::S_Interpolation;
+  test_static_index_numeric_non_unique_key_find_batch<uint32_t, uint64_t>(index_type, 4, INVALID_INDEX_PARAM);
+  test_static_index_numeric_non_unique_key_find_batch<uint64_t, uint64_t>(index_type, 4, (size_t)SegmentationType::EquiDepthSegmentationType);
+
+  index_type = IndexType::S_Binary;
+  for (size_t layers = 0; layers < 8; layers += 3) {
+    test_static_index_numeric_non_unique_key_find_batch<uint16_t, uint64_t>(index_type, layers, INVALID_INDEX_PARAM);
+    test_static_index_numeric_non_unique_key_find_batch<uint32_t, uint64_t>(index_type, layers, INVALID_INDEX_PARAM);
+    test_static_index_numeric_non_unique_key_find_batch<uint64_t, uint64_t>(index_type, layers, INVALID_INDEX_PARAM);
+  }
+
+  index_type = IndexType::S_KAry;
+  for (size_t layers = 0; layers < 3; ++layers) {
+    test_static_index_numeric_non_unique_key_find_batch<uint32_t, uint64_t>(index_type, layers, 5);
+    test_static_index_numeric_non_unique_key_find_batch<uint64_t, uint64_t>(index_type, layers, 9);
+  }
+
+  index_type = IndexType::S_Fast;
+  for (size_t layers = 0; layers <= 12; layers += 4) {
+    test_static_index_numeric_non_unique_key_find_batch<uint32_t, uint64_t>(index_type, layers, INVALID_INDEX_PARAM);
+    test_static_index_numeric_non_unique_key_find_batch<uint64_t, uint64_t>(index_type, layers, INVALID_INDEX_PARAM);
+  }
+
+  // falls back to find()
+  index_type = IndexType::S_Eytzinger;
+  test_static_index_numeric_non_unique_key_find_batch<uint32_t, uint64_t>(index_type, INVALID_INDEX_PARAM, INVALID_INDEX_PARAM);
 }
 
 
@@ -245,32 +488,57 @@ TEST_F(StaticIndexNumericTest, UniqueKeyFindRangeTest) {
     test_static_index_numeric_unique_key_find_range<uint32_t, uint64_t>(index_type, segments, INVALID_INDEX_PARAM);
     test_static_index_numeric_unique_key_find_range<uint64_t, uint64_t>(index_type, segments, INVALID_INDEX_PARAM);
   }
+  for (size_t segments = 1; segments <= 10; ++segments) {
+    test_static_index_numeric_unique_key_find_range<uint16_t, uint64_t>(index_type, segments, (size_t)SegmentationType::EquiDepthSegmentationType);
+    test_static_index_numeric_unique_key_find_range<uint32_t, uint64_t>(index_type, segments, (size_t)SegmentationType::EquiDepthSegmentationType);
+    test_static_index_numeric_unique_key_find_range<uint64_t, uint64_t>(index_type, segments, (size_t)SegmentationType::EquiDepthSegmentationType);
+  }
+
+  index_type = IndexType::S_Binary;
+  for (size_t layers = 0; layers < 8; ++layers) {
+    test_static_index_numeric_unique_key_find_range<uint16_t, uint64_t>(index_type, layers, INVALID_INDEX_PARAM);
+    test_static_index_numeric_unique_key_find_range<uint32_t, uint64_t>(index_type, layers, INVALID_INDEX_PARAM);
+    test_static_index_numeric_unique_key_find_range<uint64_t, uint64_t>(index_type, layers, INVALID_INDEX_PARAM);
+  }
+
+  index_type = IndexType::S_KAry;
+  for (size_t layers = 0; layers < 4; ++layers) {
+    for (size_t k = 2; k < 5; ++k) {
+      test_static_index_numeric_unique_key_find_range<uint16_t, uint64_t>(index_type, layers, k);
+      test_static_index_numeric_unique_key_find_range<uint32_t, uint64_t>(index_type, layers, k);
+      test_static_index_numeric_unique_key_find_range<uint64_t, uint64_t>(index_type, layers, k);
+    }
+  }
+
+  index_type = IndexType::S_Fast;
+  for (size_t layers = 0; layers <= 12; layers += 4) {
+    test_static_index_numeric_unique_key_find_range<uint32_t, uint64_t>(index_type, layers, INVALID_INDEX_PARAM);
+    test_static_index_numeric_unique_key_find_range<uint64_t, uint64_t>(index_type, layers, INVALID_INDEX_PARAM);
+  }
 
-  // index_type = IndexType::S_Binary;
-  // for (size_t layers = 0; layers < 8; ++layers) {
-  //   test_static_index_numeric_unique_key_find_range<uint16_t, uint64_t>(index_type, layers, INVALID_INDEX_PARAM);
-  //   test_static_index_numeric_unique_key_find_range<uint32_t, uint64_t>(index_type, layers, INVALID_INDEX_PARAM);
-  //   test_static_index_numeric_unique_key_find_range<uint64_t, uint64_t>(index_type, layers, INVALID_INDEX_PARAM);
-  // }
+  index_type = IndexType::S_Eytzinger;
+  test_static_index_numeric_unique_key_find_range<uint16_t, uint64_t>(index_type, INVALID_INDEX_PARAM, INVALID_INDEX_PARAM);
+  test_static_index_numeric_unique_key_find_range<uint32_t, uint64_t>(index_type, INVALID_INDEX_PARAM, INVALID_INDEX_PARAM);
+  test_static_index_numeric_unique_key_find_range<uint64_t, uint64_t>(index_type, INVALID_INDEX_PARAM, INVALID_INDEX_PARAM);
 
-  // index_type = IndexType::S_KAry;
-  // for (size_t layers = 0; layers < 4; ++layers) {
-  //   for (size_t k = 2; k < 5; ++k) {
-  //     test_static_index_numeric_unique_key_find_range<uint16_t, uint64_t>(index_type, layers, k);
-  //     test_static_index_numeric_unique_key_find_range<uint32_t, uint64_t>(index_type, layers, k);
-  //     test_static_index_numeric_unique_key_find_range<uint64_t, uint64_t>(index_type, layers, k);
-  //   }
-  // }
+  index_type = IndexType::S_Learned;
+  for (size_t models : {1, 16, 1000}) {
+    test_static_index_numeric_unique_key_find_range<uint16_t, uint64_t>(index_type, models, INVALID_INDEX_PARAM);
+    test_static_index_numeric_unique_key_find_range<uint32_t, uint64_t>(index_type, models, INVALID_INDEX_PARAM);
+    test_static_index_numeric_unique_key_find_range<uint64_t, uint64_t>(index_type, models, INVALID_INDEX_PARAM);
+  }
 
-  // index_type = IndexType::S_Fast;
-  // for (size_t layers = 0; layers <= 12; layers += 4) {
-  //   test_static_index_numeric_unique_key_find_range<uint32_t, uint64_t>(index_type, layers, INVALID_INDEX_PARAM);
-  // }
+  index_type = IndexType::S_Compressed;
+  for (size_t block_size : {1, 16, 128}) {
+    test_static_index_numeric_unique_key_find_range<uint16_t, uint64_t>(index_type, block_size, INVALID_INDEX_PARAM);
+    test_static_index_numeric_unique_key_find_range<uint32_t, uint64_t>(index_type, block_size, INVALID_INDEX_PARAM);
+    test_static_index_numeric_unique_key_find_range<uint64_t, uint64_t>(index_type, block_size, INVALID_INDEX_PARAM);
+  }
 
 }
 
 template<typename KeyT, typename ValueT>
-void test_static_index_numeric_non_unique_key_find_range(const IndexType index_type, const size_t index_param_1, const size_t index_param_2) {
+void test_static_index_numeric_non_unique_key_find_range(const IndexType index_type, const size_t index_param_1, const size_t index_param_2, const StaticLayoutType layout_type = StaticLayoutType::AoSLayoutType, const size_t thread_count = 1) {
 
   size_t n = 10000;
   size_t m = 1000;
@@ -280,7 +548,9 @@ void test_static_index_numeric_non_unique_key_find_range(const IndexType index_t
   std::unique_ptr<DataTable<KeyT, ValueT>> data_table(
     new DataTable<KeyT, ValueT>());
   std::unique_ptr<BaseIndex<KeyT, ValueT>> data_index(
-    create_numeric_index<KeyT, ValueT>(index_type, data_table.get(), index_param_1, index_param_2));
+    create_numeric_index<KeyT, ValueT>(index_type, data_table.get(), index_param_1, index_param_2, layout_type));
+
+  data_index->prepare_threads(thread_count);
 
   std::map<KeyT, std::unordered_map<Uint64, ValueT>> validation_set;
   std::vector<KeyT> keys_vector;
@@ -342,29 +612,230 @@ TEST_F(StaticIndexNumericTest, NonUniqueKeyFindRangeTest) {
     test_static_index_numeric_non_unique_key_find_range<uint32_t, uint64_t>(index_type, segments, INVALID_INDEX_PARAM);
     test_static_index_numeric_non_unique_key_find_range<uint64_t, uint64_t>(index_type, segments, INVALID_INDEX_PARAM);
   }
+  for (size_t segments = 1; segments <= 10; ++segments) {
+    // test_static_index_numeric_non_unique_key_find_range<uint16_t, uint64_t>(index_type, segments, (size_t)SegmentationType::EquiDepthSegmentationType);
+    test_static_index_numeric_non_unique_key_find_range<uint32_t, uint64_t>(index_type, segments, (size_t)SegmentationType::EquiDepthSegmentationType);
+    test_static_index_numeric_non_unique_key_find_range<uint64_t, uint64_t>(index_type, segments, (size_t)SegmentationType::EquiDepthSegmentationType);
+  }
+
+  index_type = IndexType::S_Binary;
+  for (size_t layers = 0; layers < 8; ++layers) {
+    test_static_index_numeric_non_unique_key_find_range<uint16_t, uint64_t>(index_type, layers, INVALID_INDEX_PARAM);
+    test_static_index_numeric_non_unique_key_find_range<uint32_t, uint64_t>(index_type, layers, INVALID_INDEX_PARAM);
+    test_static_index_numeric_non_unique_key_find_range<uint64_t, uint64_t>(index_type, layers, INVALID_INDEX_PARAM);
+  }
 
-  // index_type = IndexType::S_Binary;
-  // for (size_t layers = 0; layers < 8; ++layers) {
-  //   test_static_index_numeric_non_unique_key_find_range<uint16_t, uint64_t>(index_type, layers, INVALID_INDEX_PARAM);
-  //   test_static_index_numeric_non_unique_key_find_range<uint32_t, uint64_t>(index_type, layers, INVALID_INDEX_PARAM);
-  //   test_static_index_numeric_non_unique_key_find_range<uint64_t, uint64_t>(index_type, layers, INVALID_INDEX_PARAM);
-  // }
-
-  // index_type = IndexType::S_KAry;
-  // for (size_t layers = 0; layers < 4; ++layers) {
-  //   for (size_t k = 2; k < 5; ++k) {
-  //     test_static_index_numeric_non_unique_key_find_range<uint16_t, uint64_t>(index_type, layers, k);
-  //     test_static_index_numeric_non_unique_key_find_range<uint32_t, uint64_t>(index_type, layers, k);
-  //     test_static_index_numeric_non_unique_key_find_range<uint64_t, uint64_t>(index_type, layers, k);
-  //   }
-  // }
-
-  // index_type = IndexType::S_Fast;
-  // for (size_t layers = 0; layers <= 12; layers += 4) {
-  //   test_static_index_numeric_non_unique_key_find_range<uint32_t, uint64_t>(index_type, layers, INVALID_INDEX_PARAM);
-  // }
+  index_type = IndexType::S_KAry;
+  for (size_t layers = 0; layers < 4; ++layers) {
+    for (size_t k = 2; k < 5; ++k) {
+      test_static_index_numeric_non_unique_key_find_range<uint16_t, uint64_t>(index_type, layers, k);
+      test_static_index_numeric_non_unique_key_find_range<uint32_t, uint64_t>(index_type, layers, k);
+      test_static_index_numeric_non_unique_key_find_range<uint64_t, uint64_t>(index_type, layers, k);
+    }
+  }
+  // node sizes matching simd widths
+  for (size_t layers = 0; layers < 3; ++layers) {
+    for (size_t k : {5, 9, 17}) {
+      test_static_index_numeric_non_unique_key_find_range<uint16_t, uint64_t>(index_type, layers, k);
+      test_static_index_numeric_non_unique_key_find_range<uint32_t, uint64_t>(index_type, layers, k);
+      test_static_index_numeric_non_unique_key_find_range<uint64_t, uint64_t>(index_type, layers, k);
+    }
+  }
+
+  index_type = IndexType::S_Fast;
+  for (size_t layers = 0; layers <= 12; layers += 4) {
+    test_static_index_numeric_non_unique_key_find_range<uint32_t, uint64_t>(index_type, layers, INVALID_INDEX_PARAM);
+    test_static_index_numeric_non_unique_key_find_range<uint64_t, uint64_t>(index_type, layers, INVALID_INDEX_PARAM);
+  }
+
+  index_type = IndexType::S_Eytzinger;
+  test_static_index_numeric_non_unique_key_find_range<uint16_t, uint64_t>(index_type, INVALID_INDEX_PARAM, INVALID_INDEX_PARAM);
+  test_static_index_numeric_non_unique_key_find_range<uint32_t, uint64_t>(index_type, INVALID_INDEX_PARAM, INVALID_INDEX_PARAM);
+  test_static_index_numeric_non_unique_key_find_range<uint64_t, uint64_t>(index_type, INVALID_INDEX_PARAM, INVALID_INDEX_PARAM);
+
+  index_type = IndexType::S_Learned;
+  for (size_t models : {1, 16, 1000}) {
+    test_static_index_numeric_non_unique_key_find_range<uint16_t, uint64_t>(index_type, models, INVALID_INDEX_PARAM);
+    test_static_index_numeric_non_unique_key_find_range<uint32_t, uint64_t>(index_type, models, INVALID_INDEX_PARAM);
+    test_static_index_numeric_non_unique_key_find_range<uint64_t, uint64_t>(index_type, models, INVALID_INDEX_PARAM);
+  }
+
+  index_type = IndexType::S_Compressed;
+  for (size_t block_size : {1, 16, 128}) {
+    test_static_index_numeric_non_unique_key_find_range<uint16_t, uint64_t>(index_type, block_size, INVALID_INDEX_PARAM);
+    test_static_index_numeric_non_unique_key_find_range<uint32_t, uint64_t>(index_type, block_size, INVALID_INDEX_PARAM);
+    test_static_index_numeric_non_unique_key_find_range<uint64_t, uint64_t>(index_type, block_size, INVALID_INDEX_PARAM);
+  }
 }
 
+TEST_F(StaticIndexNumericTest, SoANonUniqueKeyFindRangeTest) {
+
+  StaticLayoutType layout_type = StaticLayoutType::SoALayoutType;
+
+  IndexType index_type = IndexType::S_Interpolation;
+  test_static_index_numeric_non_unique_key_find_range<uint16_t, uint64_t>(index_type, 4, INVALID_INDEX_PARAM, layout_type);
+  test_static_index_numeric_non_unique_key_find_range<uint32_t, uint64_t>(index_type, 4, INVALID_INDEX_PARAM, layout_type);
+  test_static_index_numeric_non_unique_key_find_range<uint64_t, uint64_t>(index_type, 4, INVALID_INDEX_PARAM, layout_type);
+
+  index_type = IndexType::S_Binary;
+  for (size_t layers = 0; layers < 8; layers += 3) {
+    test_static_index_numeric_non_unique_key_find_range<uint16_t, uint64_t>(index_type, layers, INVALID_INDEX_PARAM, layout_type);
+    test_static_index_numeric_non_unique_key_find_range<uint32_t, uint64_t>(index_type, layers, INVALID_INDEX_PARAM, layout_type);
+    test_static_index_numeric_non_unique_key_find_range<uint64_t, uint64_t>(index_type, layers, INVALID_INDEX_PARAM, layout_type);
+  }
+
+  index_type = IndexType::S_KAry;
+  for (size_t layers = 0; layers < 4; layers += 2) {
+    test_static_index_numeric_non_unique_key_find_range<uint16_t, uint64_t>(index_type, layers, 3, layout_type);
+    test_static_index_numeric_non_unique_key_find_range<uint32_t, uint64_t>(index_type, layers, 3, layout_type);
+    test_static_index_numeric_non_unique_key_find_range<uint64_t, uint64_t>(index_type, layers, 3, layout_type);
+  }
+
+  index_type = IndexType::S_Fast;
+  for (size_t layers = 0; layers <= 12; layers += 4) {
+    test_static_index_numeric_non_unique_key_find_range<uint32_t, uint64_t>(index_type, layers, INVALID_INDEX_PARAM, layout_type);
+  }
+
+  index_type = IndexType::S_Eytzinger;
+  test_static_index_numeric_non_unique_key_find_range<uint16_t, uint64_t>(index_type, INVALID_INDEX_PARAM, INVALID_INDEX_PARAM, layout_type);
+  test_static_index_numeric_non_unique_key_find_range<uint32_t, uint64_t>(index_type, INVALID_INDEX_PARAM, INVALID_INDEX_PARAM, layout_type);
+  test_static_index_numeric_non_unique_key_find_range<uint64_t, uint64_t>(index_type, INVALID_INDEX_PARAM, INVALID_INDEX_PARAM, layout_type);
+
+  index_type = IndexType::S_Learned;
+  test_static_index_numeric_non_unique_key_find_range<uint16_t, uint64_t>(index_type, 100, INVALID_INDEX_PARAM, layout_type);
+  test_static_index_numeric_non_unique_key_find_range<uint32_t, uint64_t>(index_type, 100, INVALID_INDEX_PARAM, layout_type);
+  test_static_index_numeric_non_unique_key_find_range<uint64_t, uint64_t>(index_type, 100, INVALID_INDEX_PARAM, layout_type);
+
+}
+
+TEST_F(StaticIndexNumericTest, ParallelNonUniqueKeyFindRangeTest) {
+
+  size_t thread_count = 4;
+
+  IndexType index_type = IndexType::S_Interpolation;
+  test_static_index_numeric_non_unique_key_find_range<uint32_t, uint64_t>(index_type, 4, INVALID_INDEX_PARAM, StaticLayoutType::AoSLayoutType, thread_count);
+  test_static_index_numeric_non_unique_key_find_range<uint64_t, uint64_t>(index_type, 4, INVALID_INDEX_PARAM, StaticLayoutType::SoALayoutType, thread_count);
+
+  index_type = IndexType::S_Binary;
+  test_static_index_numeric_non_unique_key_find_range<uint32_t, uint64_t>(index_type, 7, INVALID_INDEX_PARAM, StaticLayoutType::AoSLayoutType, thread_count);
+  test_static_index_numeric_non_unique_key_find_range<uint64_t, uint64_t>(index_type, 7, INVALID_INDEX_PARAM, StaticLayoutType::SoALayoutType, thread_count);
+
+  index_type = IndexType::S_KAry;
+  test_static_index_numeric_non_unique_key_find_range<uint32_t, uint64_t>(index_type, 3, 4, StaticLayoutType::AoSLayoutType, thread_count);
+  test_static_index_numeric_non_unique_key_find_range<uint64_t, uint64_t>(index_type, 3, 4, StaticLayoutType::SoALayoutType, thread_count);
+
+  index_type = IndexType::S_Fast;
+  test_static_index_numeric_non_unique_key_find_range<uint32_t, uint64_t>(index_type, 8, INVALID_INDEX_PARAM, StaticLayoutType::AoSLayoutType, thread_count);
+  test_static_index_numeric_non_unique_key_find_range<uint32_t, uint64_t>(index_type, 8, INVALID_INDEX_PARAM, StaticLayoutType::SoALayoutType, thread_count);
+
+  index_type = IndexType::S_Eytzinger;
+  test_static_index_numeric_non_unique_key_find_range<uint32_t, uint64_t>(index_type, INVALID_INDEX_PARAM, INVALID_INDEX_PARAM, StaticLayoutType::AoSLayoutType, thread_count);
+  test_static_index_numeric_non_unique_key_find_range<uint64_t, uint64_t>(index_type, INVALID_INDEX_PARAM, INVALID_INDEX_PARAM, StaticLayoutType::SoALayoutType, thread_count);
+
+  index_type = IndexType::S_Learned;
+  test_static_index_numeric_non_unique_key_find_range<uint32_t, uint64_t>(index_type, 100, INVALID_INDEX_PARAM, StaticLayoutType::AoSLayoutType, thread_count);
+  test_static_index_numeric_non_unique_key_find_range<uint64_t, uint64_t>(index_type, 100, INVALID_INDEX_PARAM, StaticLayoutType::SoALayoutType, thread_count);
+
+}
+
+
+// keys are drawn from the whole domain of KeyT, including keys with the top bit set.
+template<typename KeyT, typename ValueT>
+void test_static_index_numeric_full_range_key_find(const IndexType index_type, const size_t index_param_1, const size_t index_param_2) {
+
+  size_t n = 10000;
+
+  FastRandom rand_gen(0);
+
+  std::unique_ptr<DataTable<KeyT, ValueT>> data_table(
+    new DataTable<KeyT, ValueT>());
+  std::unique_ptr<BaseIndex<KeyT, ValueT>> data_index(
+    create_numeric_index<KeyT, ValueT>(index_type, data_table.get(), index_param_1, index_param_2));
+
+  std::map<KeyT, std::unordered_map<Uint64, ValueT>> validation_set;
+
+  // insert
+  for (size_t i = 0; i < n; ++i) {
+
+    KeyT key = rand_gen.next<KeyT>();
+    ValueT value = i + 2048;
+    
+    OffsetT offset = data_table->insert_tuple(key, value);
+    
+    validation_set[key][offset.raw_data()] = value;
+  }
+
+  // reorganize data
+  data_index->reorganize();
+
+  // find
+  for (auto entry : validation_set) {
+    KeyT key = entry.first;
+
+    std::vector<Uint64> offsets;
+
+    data_index->find(key, offsets);
+
+    EXPECT_EQ(offsets.size(), entry.second.size());
+  }
+
+  // find range
+  for (size_t i = 0; i < 100; ++i) {
+    KeyT lhs_key = rand_gen.next<KeyT>();
+    KeyT rhs_key = rand_gen.next<KeyT>();
+    if (lhs_key > rhs_key) {
+      std::swap(lhs_key, rhs_key);
+    }
+
+    size_t expected_size = 0;
+    for (auto iter = validation_set.lower_bound(lhs_key); iter != validation_set.upper_bound(rhs_key); ++iter) {
+      expected_size += iter->second.size();
+    }
+
+    std::vector<Uint64> offsets;
+
+    data_index->find_range(lhs_key, rhs_key, offsets);
+
+    EXPECT_EQ(offsets.size(), expected_size);
+  }
+}
+
+TEST_F(StaticIndexNumericTest, FullRangeKeyFindTest) {
+
+  IndexType index_type = IndexType::S_Binary;
+  test_static_index_numeric_full_range_key_find<uint32_t, uint64_t>(index_type, 4, INVALID_INDEX_PARAM);
+  test_static_index_numeric_full_range_key_find<uint64_t, uint64_t>(index_type, 4, INVALID_INDEX_PARAM);
+
+  index_type = IndexType::S_KAry;
+  test_static_index_numeric_full_range_key_find<uint32_t, uint64_t>(index_type, 3, 3);
+  test_static_index_numeric_full_range_key_find<uint64_t, uint64_t>(index_type, 3, 3);
+  for (size_t k : {5, 9, 17}) {
+    test_static_index_numeric_full_range_key_find<uint32_t, uint64_t>(index_type, 2, k);
+    test_static_index_numeric_full_range_key_find<uint64_t, uint64_t>(index_type, 2, k);
+  }
+
+  index_type = IndexType::S_Fast;
+  for (size_t layers = 4; layers <= 12; layers += 4) {
+    test_static_index_numeric_full_range_key_find<uint32_t, uint64_t>(index_type, layers, INVALID_INDEX_PARAM);
+    test_static_index_numeric_full_range_key_find<uint64_t, uint64_t>(index_type, layers, INVALID_INDEX_PARAM);
+  }
+
+  index_type = IndexType::S_Eytzinger;
+  test_static_index_numeric_full_range_key_find<uint32_t, uint64_t>(index_type, INVALID_INDEX_PARAM, INVALID_INDEX_PARAM);
+  test_static_index_numeric_full_range_key_find<uint64_t, uint64_t>(index_type, INVALID_INDEX_PARAM, INVALID_INDEX_PARAM);
+
+  index_type = IndexType::S_Learned;
+  for (size_t models : {1, 16, 1000}) {
+    test_static_index_numeric_full_range_key_find<uint32_t, uint64_t>(index_type, models, INVALID_INDEX_PARAM);
+    test_static_index_numeric_full_range_key_find<uint64_t, uint64_t>(index_type, models, INVALID_INDEX_PARAM);
+  }
+
+  index_type = IndexType::S_Compressed;
+  for (size_t block_size : {1, 16, 128}) {
+    test_static_index_numeric_full_range_key_find<uint32_t, uint64_t>(index_type, block_size, INVALID_INDEX_PARAM);
+    test_static_index_numeric_full_range_key_find<uint64_t, uint64_t>(index_type, block_size, INVALID_INDEX_PARAM);
+  }
+}
 
 template<typename KeyT, typename ValueT>
 void test_static_index_numeric_scan(const IndexType index_type, const size_t index_param_1, const size_t index_param_2) {
@@ -424,6 +895,433 @@ TEST_F(StaticIndexNumericTest, ScanTest) {
 }
 
 
+template<typename KeyT, typename ValueT>
+void test_static_index_numeric_non_unique_key_scan(const IndexType index_type, const size_t index_param_1, const size_t index_param_2) {
+
+  size_t n = 10000;
+  size_t m = 1000;
+
+  FastRandom rand_gen(0);
+
+  std::unique_ptr<DataTable<KeyT, ValueT>> data_table(
+    new DataTable<KeyT, ValueT>());
+  std::unique_ptr<BaseIndex<KeyT, ValueT>> data_index(
+    create_numeric_index<KeyT, ValueT>(index_type, data_table.get(), index_param_1, index_param_2));
+
+  std::unordered_map<KeyT, std::unordered_set<Uint64>> validation_set;
+
+  // insert
+  for (size_t i = 0; i < n; ++i) {
+
+    KeyT key = rand_gen.next<KeyT>() % m;
+    ValueT value = i + 2048;
+
+    OffsetT offset = data_table->insert_tuple(key, value);
+
+    validation_set[key].insert(offset.raw_data());
+  }
+
+  // reorganize data
+  data_index->reorganize();
+
+  // scan keys in and out of the key range
+  for (size_t key = 0; key <= m; ++key) {
+
+    std::vector<Uint64> offsets;
+    data_index->scan(key, offsets);
+
+    std::vector<Uint64> reverse_offsets;
+    data_index->scan_reverse(key, reverse_offsets);
+
+    auto iter = validation_set.find(key);
+    size_t real_size = (iter == validation_set.end()) ? 0 : iter->second.size();
+
+    EXPECT_EQ(real_size, offsets.size());
+    EXPECT_EQ(real_size, reverse_offsets.size());
+
+    for (auto offset : offsets) {
+      EXPECT_NE(iter->second.end(), iter->second.find(offset));
+    }
+
+    std::reverse(reverse_offsets.begin(), reverse_offsets.end());
+    EXPECT_EQ(offsets, reverse_offsets);
+  }
+}
+
+
+TEST_F(StaticIndexNumericTest, NonUniqueKeyScanTest) {
+
+  IndexType index_type = IndexType::S_Interpolation;
+  test_static_index_numeric_non_unique_key_scan<uint32_t, uint64_t>(index_type, 4, INVALID_INDEX_PARAM);
+  test_static_index_numeric_non_unique_key_scan<uint64_t, uint64_t>(index_type, 4, (int)SegmentationType::EquiDepthSegmentationType);
+
+  index_type = IndexType::S_Binary;
+  test_static_index_numeric_non_unique_key_scan<uint16_t, uint64_t>(index_type, 0, INVALID_INDEX_PARAM);
+  test_static_index_numeric_non_unique_key_scan<uint64_t, uint64_t>(index_type, 7, INVALID_INDEX_PARAM);
+
+  index_type = IndexType::S_KAry;
+  test_static_index_numeric_non_unique_key_scan<uint32_t, uint64_t>(index_type, 3, 5);
+
+  index_type = IndexType::S_Fast;
+  test_static_index_numeric_non_unique_key_scan<uint32_t, uint64_t>(index_type, 8, INVALID_INDEX_PARAM);
+
+  index_type = IndexType::S_Eytzinger;
+  test_static_index_numeric_non_unique_key_scan<uint64_t, uint64_t>(index_type, INVALID_INDEX_PARAM, INVALID_INDEX_PARAM);
+
+  index_type = IndexType::S_Learned;
+  test_static_index_numeric_non_unique_key_scan<uint32_t, uint64_t>(index_type, 16, INVALID_INDEX_PARAM);
+
+  index_type = IndexType::S_Compressed;
+  test_static_index_numeric_non_unique_key_scan<uint64_t, uint64_t>(index_type, 16, INVALID_INDEX_PARAM);
+}
+
+
+
+
+
+
+
+template<typename KeyT, typename ValueT>
+void test_static_index_numeric_delta_update(const IndexType index_type, const size_t index_param_1, const size_t index_param_2, const size_t merge_threshold) {
+
+  size_t n = 10000;
+  size_t m = 1000;
+
+  FastRandom rand_gen(0);
+
+  std::unique_ptr<DataTable<KeyT, ValueT>> data_table(
+    new DataTable<KeyT, ValueT>());
+  std::unique_ptr<BaseIndex<KeyT, ValueT>> data_index(
+    create_delta_index<KeyT, ValueT>(index_type, data_table.get(), merge_threshold, index_param_1, index_param_2));
+
+  std::map<KeyT, std::unordered_set<Uint64>> validation_set;
+
+  auto validate_find = [&](const KeyT key) {
+    std::vector<Uint64> offsets;
+    data_index->find(key, offsets);
+
+    auto iter = validation_set.find(key);
+    size_t real_size = (iter == validation_set.end()) ? 0 : iter->second.size();
+    EXPECT_EQ(real_size, offsets.size());
+
+    for (auto offset : offsets) {
+      EXPECT_NE(iter, validation_set.end());
+      if (iter == validation_set.end()) { break; }
+      EXPECT_NE(iter->second.end(), iter->second.find(offset));
+    }
+  };
+
+  auto validate_find_range = [&](const KeyT lhs_key, const KeyT rhs_key) {
+    std::vector<Uint64> offsets;
+    data_index->find_range(lhs_key, rhs_key, offsets);
+
+    std::unordered_set<Uint64> real_offsets;
+    for (auto iter = validation_set.lower_bound(lhs_key); iter != validation_set.upper_bound(rhs_key); ++iter) {
+      real_offsets.insert(iter->second.begin(), iter->second.end());
+    }
+    EXPECT_EQ(real_offsets.size(), offsets.size());
+
+    for (auto offset : offsets) {
+      EXPECT_NE(real_offsets.end(), real_offsets.find(offset));
+    }
+  };
+
+  // insert
+  for (size_t i = 0; i < n; ++i) {
+
+    KeyT key = rand_gen.next<KeyT>() % m;
+    ValueT value = i + 2048;
+
+    OffsetT offset = data_table->insert_tuple(key, value);
+    data_index->insert(key, offset.raw_data());
+
+    validation_set[key].insert(offset.raw_data());
+  }
+
+  // reorganize data
+  data_index->reorganize();
+
+  // interleave updates and lookups, while merges run in the background
+  for (size_t i = 0; i < n; ++i) {
+
+    KeyT key = rand_gen.next<KeyT>() % m;
+
+    if (i % 4 == 0) {
+      data_index->erase(key);
+      validation_set.erase(key);
+    } else {
+      ValueT value = i + 2048;
+
+      OffsetT offset = data_table->insert_tuple(key, value);
+      data_index->insert(key, offset.raw_data());
+
+      validation_set[key].insert(offset.raw_data());
+    }
+
+    if (i % 10 == 0) {
+      validate_find(rand_gen.next<KeyT>() % m);
+    }
+    if (i % 100 == 0) {
+      KeyT lhs_key = rand_gen.next<KeyT>() % m;
+      validate_find_range(lhs_key, lhs_key + rand_gen.next<KeyT>() % (m / 10));
+    }
+  }
+
+  size_t real_size = 0;
+  for (auto &entry : validation_set) {
+    real_size += entry.second.size();
+  }
+  EXPECT_EQ(real_size, data_index->size());
+
+  // merge all updates
+  data_index->reorganize();
+
+  for (size_t key = 0; key < m; ++key) {
+    validate_find(key);
+  }
+  validate_find_range(0, m);
+}
+
+
+// merges with a small threshold on layered indexes, while the number of entries
+// grows past the minimum size of the wrapped index, and drops below it again.
+template<typename KeyT, typename ValueT>
+void test_static_index_numeric_delta_min_size(const IndexType index_type, const size_t index_param_1, const size_t index_param_2) {
+
+  size_t n = 5000;
+  size_t merge_threshold = 10;
+
+  std::unique_ptr<DataTable<KeyT, ValueT>> data_table(
+    new DataTable<KeyT, ValueT>());
+  std::unique_ptr<BaseIndex<KeyT, ValueT>> data_index(
+    create_delta_index<KeyT, ValueT>(index_type, data_table.get(), merge_threshold, index_param_1, index_param_2));
+
+  std::map<KeyT, Uint64> validation_set;
+
+  auto validate_find = [&](const KeyT key) {
+    std::vector<Uint64> offsets;
+    data_index->find(key, offsets);
+
+    auto iter = validation_set.find(key);
+    if (iter == validation_set.end()) {
+      EXPECT_EQ(0, offsets.size());
+    } else {
+      EXPECT_EQ(1, offsets.size());
+      if (offsets.size() == 1) {
+        EXPECT_EQ(iter->second, offsets[0]);
+      }
+    }
+  };
+
+  // the first merges are deferred until the minimum size is reached
+  for (size_t i = 0; i < n; ++i) {
+    KeyT key = i;
+    OffsetT offset = data_table->insert_tuple(key, i);
+    data_index->insert(key, offset.raw_data());
+    validation_set[key] = offset.raw_data();
+
+    validate_find(i / 2);
+  }
+  data_index->reorganize();
+
+  // erase down to a few entries, below the minimum size
+  for (size_t i = 0; i < n - 5; ++i) {
+    KeyT key = i;
+    data_index->erase(key);
+    validation_set.erase(key);
+
+    validate_find(i + 1);
+    validate_find(i / 2);
+  }
+  data_index->reorganize();
+  EXPECT_EQ(5, data_index->size());
+
+  // erase all, then grow again
+  for (size_t i = n - 5; i < n; ++i) {
+    KeyT key = i;
+    data_index->erase(key);
+    validation_set.erase(key);
+  }
+  data_index->reorganize();
+  EXPECT_EQ(0, data_index->size());
+
+  for (size_t i = 0; i < n; ++i) {
+    KeyT key = i;
+    OffsetT offset = data_table->insert_tuple(key, i);
+    data_index->insert(key, offset.raw_data());
+    validation_set[key] = offset.raw_data();
+  }
+  data_index->reorganize();
+
+  for (size_t i = 0; i < n; ++i) {
+    validate_find(i);
+  }
+}
+
+
+TEST_F(StaticIndexNumericTest, EytzingerEmptyTableTest) {
 
+  std::unique_ptr<DataTable<uint64_t, uint64_t>> data_table(
+    new DataTable<uint64_t, uint64_t>());
+  std::unique_ptr<BaseIndex<uint64_t, uint64_t>> data_index(
+    create_numeric_index<uint64_t, uint64_t>(IndexType::S_Eytzinger, data_table.get(), INVALID_INDEX_PARAM, INVALID_INDEX_PARAM));
 
+  data_index->reorganize();
+  EXPECT_EQ(0, data_index->size());
 
+  std::vector<Uint64> offsets;
+  data_index->find(0, offsets);
+  data_index->find_range(0, 100, offsets);
+  EXPECT_EQ(0, offsets.size());
+}
+
+
+TEST_F(StaticIndexNumericTest, DeltaMinSizeTest) {
+
+  IndexType index_type = IndexType::S_Binary;
+  test_static_index_numeric_delta_min_size<uint32_t, uint64_t>(index_type, 10, INVALID_INDEX_PARAM);
+
+  index_type = IndexType::S_KAry;
+  test_static_index_numeric_delta_min_size<uint64_t, uint64_t>(index_type, 6, 3);
+
+  index_type = IndexType::S_Fast;
+  test_static_index_numeric_delta_min_size<uint32_t, uint64_t>(index_type, 12, INVALID_INDEX_PARAM);
+}
+
+
+TEST_F(StaticIndexNumericTest, DeltaUpdateTest) {
+
+  // the first merges hold merge_threshold entries, so the inner layers are kept small.
+  for (size_t merge_threshold : {500, 5000, 100000}) {
+
+    IndexType index_type = IndexType::S_Interpolation;
+    test_static_index_numeric_delta_update<uint32_t, uint64_t>(index_type, 4, INVALID_INDEX_PARAM, merge_threshold);
+
+    index_type = IndexType::S_Binary;
+    test_static_index_numeric_delta_update<uint16_t, uint64_t>(index_type, 5, INVALID_INDEX_PARAM, merge_threshold);
+
+    index_type = IndexType::S_KAry;
+    test_static_index_numeric_delta_update<uint64_t, uint64_t>(index_type, 2, 9, merge_threshold);
+
+    index_type = IndexType::S_Fast;
+    test_static_index_numeric_delta_update<uint32_t, uint64_t>(index_type, 4, INVALID_INDEX_PARAM, merge_threshold);
+
+    index_type = IndexType::S_Eytzinger;
+    test_static_index_numeric_delta_update<uint64_t, uint64_t>(index_type, INVALID_INDEX_PARAM, INVALID_INDEX_PARAM, merge_threshold);
+
+    index_type = IndexType::S_Learned;
+    test_static_index_numeric_delta_update<uint32_t, uint64_t>(index_type, 16, INVALID_INDEX_PARAM, merge_threshold);
+
+    index_type = IndexType::S_Compressed;
+    test_static_index_numeric_delta_update<uint64_t, uint64_t>(index_type, 32, INVALID_INDEX_PARAM, merge_threshold);
+  }
+}
+
+
+// updates from several threads, while other threads look up keys and merges run in the background.
+// each updating thread inserts its own keys, and erases every fourth of them.
+template<typename KeyT, typename ValueT>
+void test_static_index_numeric_delta_concurrent_update(const IndexType index_type, const size_t index_param_1, const size_t index_param_2) {
+
+  size_t n = 10000;
+  size_t m = 20000;
+  size_t merge_threshold = 500;
+  size_t update_thread_count = 2;
+  size_t lookup_thread_count = 2;
+
+  std::unique_ptr<DataTable<KeyT, ValueT>> data_table(
+    new DataTable<KeyT, ValueT>());
+  std::unique_ptr<BaseIndex<KeyT, ValueT>> data_index(
+    create_delta_index<KeyT, ValueT>(index_type, data_table.get(), merge_threshold, index_param_1, index_param_2));
+
+  // keys below m are inserted before the threads start, and never updated
+  for (size_t i = 0; i < m; ++i) {
+    KeyT key = i;
+    OffsetT offset = data_table->insert_tuple(key, i);
+    data_index->insert(key, offset.raw_data());
+  }
+  data_index->reorganize();
+
+  std::vector<std::map<KeyT, Uint64>> validation_sets(update_thread_count);
+
+  std::atomic<bool> is_running(true);
+  std::atomic<size_t> lookup_failure_count(0);
+
+  std::vector<std::thread> lookup_threads;
+  for (size_t thread_id = 0; thread_id < lookup_thread_count; ++thread_id) {
+    lookup_threads.emplace_back([&, thread_id]() {
+      FastRandom rand_gen(thread_id);
+      while (is_running) {
+        KeyT key = rand_gen.next<KeyT>() % m;
+
+        std::vector<Uint64> offsets;
+        data_index->find(key, offsets);
+        if (offsets.size() != 1) {
+          ++lookup_failure_count;
+        }
+
+        offsets.clear();
+        data_index->find_range(key, key + 9, offsets);
+        if (offsets.size() < std::min((size_t)10, (size_t)(m - key))) {
+          ++lookup_failure_count;
+        }
+      }
+    });
+  }
+
+  std::vector<std::thread> update_threads;
+  for (size_t thread_id = 0; thread_id < update_thread_count; ++thread_id) {
+    update_threads.emplace_back([&, thread_id]() {
+      for (size_t i = 0; i < n; ++i) {
+        KeyT key = m + i * update_thread_count + thread_id;
+
+        OffsetT offset = data_table->insert_tuple(key, i);
+        data_index->insert(key, offset.raw_data());
+        validation_sets[thread_id][key] = offset.raw_data();
+
+        if (i % 4 == 0) {
+          data_index->erase(key);
+          validation_sets[thread_id].erase(key);
+        }
+      }
+    });
+  }
+  for (auto &thread : update_threads) {
+    thread.join();
+  }
+  is_running = false;
+  for (auto &thread : lookup_threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(0, lookup_failure_count.load());
+
+  size_t real_size = m;
+  for (auto &validation_set : validation_sets) {
+    real_size += validation_set.size();
+  }
+  EXPECT_EQ(real_size, data_index->size());
+
+  data_index->reorganize();
+
+  for (auto &validation_set : validation_sets) {
+    for (auto &entry : validation_set) {
+      std::vector<Uint64> offsets;
+      data_index->find(entry.first, offsets);
+      EXPECT_EQ(1, offsets.size());
+      if (offsets.size() == 1) {
+        EXPECT_EQ(entry.second, offsets[0]);
+      }
+    }
+  }
+}
+
+
+TEST_F(StaticIndexNumericTest, DeltaConcurrentUpdateTest) {
+
+  IndexType index_type = IndexType::S_Binary;
+  test_static_index_numeric_delta_concurrent_update<uint32_t, uint64_t>(index_type, 5, INVALID_INDEX_PARAM);
+
+  index_type = IndexType::S_Eytzinger;
+  test_static_index_numeric_delta_concurrent_update<uint64_t, uint64_t>(index_type, INVALID_INDEX_PARAM, INVALID_INDEX_PARAM);
+}